@@ -0,0 +1,19 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Parallel algorithms
+ */
+
+#include "Algorithms.hpp"
+
+using namespace kF;
+
+std::size_t Flow::Algorithms::ChunkCount(const std::size_t count, const std::size_t grainSize) noexcept
+{
+    const auto grain = std::max(grainSize, 1ul);
+    const auto maxChunks = (count + grain - 1ul) / grain;
+    std::size_t workers { 1ul };
+
+    if (const auto worker = Worker::Current(); worker)
+        workers += worker->parent().idleWorkerCount();
+    return std::max(std::min(maxChunks, workers * ChunksPerWorker), 1ul);
+}
@@ -0,0 +1,55 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Parallel algorithms
+ */
+
+#pragma once
+
+#include <concepts>
+#include <iterator>
+#include <functional>
+
+#include "Scheduler.hpp"
+
+/**
+ * @brief Each algorithm emplaces a single dynamic node into a graph and returns its task
+ *  The work is split when the node is executed, according to the number of available workers
+ *  Ranges and callables must remain valid until the node is executed
+ */
+namespace kF::Flow::Algorithms
+{
+    /** @brief Number of chunks created for each available worker, to balance uneven iterations */
+    constexpr std::size_t ChunksPerWorker { 4ul };
+
+    /** @brief Get the number of chunks to split 'count' iterations into
+     *  The result depends on the number of IDLE workers of the calling worker's scheduler */
+    [[nodiscard]] std::size_t ChunkCount(const std::size_t count, const std::size_t grainSize) noexcept;
+
+    /** @brief Call 'func(index)' for each index in [begin, end[ with a given positive step */
+    template<std::integral Index, typename Func>
+        requires std::invocable<Func &, Index>
+    Task parallelFor(Graph &graph, const Index begin, const Index end, const Index step, Func &&func, const std::size_t grainSize = 1ul);
+
+    /** @brief Store 'func(*it)' for each iterator of [first, last[ into the range starting at 'out' */
+    template<std::random_access_iterator InputIterator, std::random_access_iterator OutputIterator, typename Func>
+    Task parallelTransform(Graph &graph, const InputIterator first, const InputIterator last, const OutputIterator out,
+            Func &&func, const std::size_t grainSize = 1ul);
+
+    /** @brief Reduce [first, last[ into 'result' using 'op(result, value)' (the operation must be associative)
+     *  The value type must be default constructible */
+    template<std::random_access_iterator Iterator, typename Type, typename BinaryOperation>
+    Task parallelReduce(Graph &graph, const Iterator first, const Iterator last, Type &result,
+            BinaryOperation &&op, const std::size_t grainSize = 1ul);
+
+    /** @brief Sort [first, last[ using a comparison function (sorted chunks are merged pairwise) */
+    template<std::random_access_iterator Iterator, typename Compare = std::less<>>
+    Task parallelSort(Graph &graph, const Iterator first, const Iterator last, Compare &&compare = Compare(), const std::size_t grainSize = 1ul);
+
+    /** @brief Store the inclusive scan of [first, last[ into the range starting at 'out' (the operation must be associative)
+     *  The value type must be default constructible, 'out' can be equal to 'first' */
+    template<std::random_access_iterator InputIterator, std::random_access_iterator OutputIterator, typename BinaryOperation = std::plus<>>
+    Task parallelScan(Graph &graph, const InputIterator first, const InputIterator last, const OutputIterator out,
+            BinaryOperation &&op = BinaryOperation(), const std::size_t grainSize = 1ul);
+}
+
+#include "Algorithms.ipp"
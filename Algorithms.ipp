@@ -0,0 +1,169 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Parallel algorithms
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+template<std::integral Index, typename Func>
+    requires std::invocable<Func &, Index>
+inline kF::Flow::Task kF::Flow::Algorithms::parallelFor(Graph &graph, const Index begin, const Index end, const Index step,
+        Func &&func, const std::size_t grainSize)
+{
+    kFAssert(step > 0,
+        throw std::logic_error("Flow::Algorithms::parallelFor: Step must be positive"));
+    return graph.emplace([begin, end, step, grainSize, func = std::forward<Func>(func)](Graph &sub) mutable {
+        const auto count = begin < end ? static_cast<std::size_t>((end - begin + step - 1) / step) : 0ul;
+        const auto chunkCount = ChunkCount(count, grainSize);
+        sub.clear();
+        for (auto chunk = 0ul; chunk < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            sub.emplace([begin, step, from, to, &func] {
+                for (auto i = from; i < to; ++i)
+                    func(static_cast<Index>(begin + static_cast<Index>(i) * step));
+            });
+        }
+    });
+}
+
+template<std::random_access_iterator InputIterator, std::random_access_iterator OutputIterator, typename Func>
+inline kF::Flow::Task kF::Flow::Algorithms::parallelTransform(Graph &graph, const InputIterator first, const InputIterator last,
+        const OutputIterator out, Func &&func, const std::size_t grainSize)
+{
+    return graph.emplace([first, last, out, grainSize, func = std::forward<Func>(func)](Graph &sub) mutable {
+        const auto count = static_cast<std::size_t>(std::distance(first, last));
+        const auto chunkCount = ChunkCount(count, grainSize);
+        sub.clear();
+        for (auto chunk = 0ul; chunk < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            sub.emplace([first, out, from, to, &func] {
+                std::transform(first + from, first + to, out + from, func);
+            });
+        }
+    });
+}
+
+template<std::random_access_iterator Iterator, typename Type, typename BinaryOperation>
+inline kF::Flow::Task kF::Flow::Algorithms::parallelReduce(Graph &graph, const Iterator first, const Iterator last, Type &result,
+        BinaryOperation &&op, const std::size_t grainSize)
+{
+    using Value = std::iter_value_t<Iterator>;
+
+    return graph.emplace([first, last, &result, grainSize, op = std::forward<BinaryOperation>(op), partials = std::vector<Value>()](Graph &sub) mutable {
+        const auto count = static_cast<std::size_t>(std::distance(first, last));
+        const auto chunkCount = std::min(ChunkCount(count, grainSize), count);
+        sub.clear();
+        if (!chunkCount)
+            return;
+        partials.resize(chunkCount);
+        auto join = sub.emplace([&result, &op, &partials] {
+            for (const auto &partial : partials)
+                result = op(result, partial);
+        });
+        for (auto chunk = 0ul; chunk < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            auto task = sub.emplace([first, from, to, &op, &partial = partials[chunk]] {
+                partial = first[from];
+                for (auto i = from + 1; i < to; ++i)
+                    partial = op(partial, first[i]);
+            });
+            task.precede(join);
+        }
+    });
+}
+
+template<std::random_access_iterator Iterator, typename Compare>
+inline kF::Flow::Task kF::Flow::Algorithms::parallelSort(Graph &graph, const Iterator first, const Iterator last,
+        Compare &&compare, const std::size_t grainSize)
+{
+    struct Range
+    {
+        Task task;
+        std::size_t from;
+        std::size_t to;
+    };
+
+    return graph.emplace([first, last, grainSize, compare = std::forward<Compare>(compare)](Graph &sub) mutable {
+        const auto count = static_cast<std::size_t>(std::distance(first, last));
+        const auto chunkCount = ChunkCount(count, grainSize);
+        std::vector<Range> ranges;
+        std::vector<Range> merged;
+
+        sub.clear();
+        ranges.reserve(chunkCount);
+        for (auto chunk = 0ul; chunk < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            ranges.push_back(Range {
+                task: sub.emplace([first, from, to, &compare] { std::sort(first + from, first + to, compare); }),
+                from: from,
+                to: to
+            });
+        }
+        // Merge adjacent sorted ranges pairwise until a single one remains
+        while (ranges.size() > 1) {
+            merged.clear();
+            for (auto i = 0ul; i + 1 < ranges.size(); i += 2) {
+                auto &left = ranges[i];
+                auto &right = ranges[i + 1];
+                auto task = sub.emplace([first, from = left.from, middle = left.to, to = right.to, &compare] {
+                    std::inplace_merge(first + from, first + middle, first + to, compare);
+                });
+                task.succeed(left.task);
+                task.succeed(right.task);
+                merged.push_back(Range { task: task, from: left.from, to: right.to });
+            }
+            if (ranges.size() % 2)
+                merged.push_back(ranges.back());
+            std::swap(ranges, merged);
+        }
+    });
+}
+
+template<std::random_access_iterator InputIterator, std::random_access_iterator OutputIterator, typename BinaryOperation>
+inline kF::Flow::Task kF::Flow::Algorithms::parallelScan(Graph &graph, const InputIterator first, const InputIterator last,
+        const OutputIterator out, BinaryOperation &&op, const std::size_t grainSize)
+{
+    using Value = std::iter_value_t<InputIterator>;
+
+    return graph.emplace([first, last, out, grainSize, op = std::forward<BinaryOperation>(op), sums = std::vector<Value>()](Graph &sub) mutable {
+        const auto count = static_cast<std::size_t>(std::distance(first, last));
+        const auto chunkCount = std::min(ChunkCount(count, grainSize), count);
+        sub.clear();
+        if (!chunkCount)
+            return;
+        // Reduce every chunk but the last one, then accumulate the sums serially
+        sums.resize(chunkCount);
+        auto accumulate = sub.emplace([&op, &sums] {
+            for (auto i = 1ul; i < sums.size() - 1; ++i)
+                sums[i] = op(sums[i - 1], sums[i]);
+        });
+        for (auto chunk = 0ul; chunk + 1 < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            auto task = sub.emplace([first, from, to, &op, &sum = sums[chunk]] {
+                sum = first[from];
+                for (auto i = from + 1; i < to; ++i)
+                    sum = op(sum, first[i]);
+            });
+            task.precede(accumulate);
+        }
+        // Scan every chunk, offset by the sum of the previous ones
+        for (auto chunk = 0ul; chunk < chunkCount; ++chunk) {
+            const auto from = count * chunk / chunkCount;
+            const auto to = count * (chunk + 1) / chunkCount;
+            auto task = sub.emplace([first, out, from, to, chunk, &op, &sums] {
+                if (!chunk)
+                    std::inclusive_scan(first + from, first + to, out + from, op);
+                else
+                    std::inclusive_scan(first + from, first + to, out + from, op, sums[chunk - 1]);
+            });
+            task.succeed(accumulate);
+        }
+    });
+}
@@ -0,0 +1,73 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Exponential backoff used by waiting threads
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+#endif
+
+namespace kF::Flow
+{
+    class Backoff;
+}
+
+/** @brief Busy wait with an exponentially growing number of pause instructions, then fall back to yielding */
+class kF::Flow::Backoff
+{
+public:
+    /** @brief Default number of spinning rounds before yielding */
+    static constexpr std::uint32_t DefaultSpinCount { 16u };
+
+    /** @brief Maximum number of pause instructions of a single round */
+    static constexpr std::uint32_t MaxPauseCount { 64u };
+
+    /** @brief Construct a backoff that spins 'spinCount' rounds */
+    Backoff(const std::uint32_t spinCount = DefaultSpinCount) noexcept : _spinCount(spinCount) {}
+
+    /** @brief Pause the current core for a few cycles without releasing it */
+    static void Pause(void) noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    /** @brief Spin a single round, returns false once every round was spent */
+    bool spin(void) noexcept
+    {
+        if (_round == _spinCount)
+            return false;
+        for (auto i = 0u, count = 1u << std::min(_round, 6u); i < count; ++i)
+            Pause();
+        ++_round;
+        return true;
+    }
+
+    /** @brief Spin a single round, or yield the thread once every round was spent */
+    void wait(void) noexcept
+    {
+        if (!spin())
+            std::this_thread::yield();
+    }
+
+    /** @brief Restart from the shortest round */
+    void reset(void) noexcept { _round = 0u; }
+
+private:
+    std::uint32_t _spinCount { 0u };
+    std::uint32_t _round { 0u };
+};
+
+static_assert(kF::Flow::Backoff::MaxPauseCount == 1u << 6u, "Backoff: Rounds are capped at 2^6 pauses");
@@ -4,6 +4,9 @@ get_filename_component(KubeFlowBenchmarksDir ${CMAKE_CURRENT_LIST_FILE} PATH)
 
 set(KubeFlowBenchmarksSources
     ${KubeFlowBenchmarksDir}/Main.cpp
+    ${KubeFlowBenchmarksDir}/benchmarks_Graph.cpp
+    ${KubeFlowBenchmarksDir}/benchmarks_Scheduler.cpp
+    ${KubeFlowBenchmarksDir}/benchmarks_Workloads.cpp
 )
 
 add_executable(${CMAKE_PROJECT_NAME} ${KubeFlowBenchmarksSources})
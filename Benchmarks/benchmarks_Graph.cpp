@@ -0,0 +1,55 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Benchmarks of the Graph
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <Kube/Flow/Scheduler.hpp>
+
+using namespace kF;
+
+/** @brief Preprocess a freshly built layered graph of 'range(0)' nodes with 'range(1)' switches at its top */
+static void Graph_PreprocessSwitches(benchmark::State &state)
+{
+    const auto nodeCount = static_cast<std::size_t>(state.range(0));
+    const auto switchCount = static_cast<std::size_t>(state.range(1));
+    constexpr std::size_t LayerWidth = 64;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Flow::Graph graph;
+        std::vector<Flow::Task> previous, current;
+        for (auto i = 0ul; i < switchCount; ++i)
+            previous.push_back(graph.emplace([]() -> bool { return false; }));
+        while (graph.size() < nodeCount) {
+            current.clear();
+            for (auto i = 0ul; i < LayerWidth; ++i) {
+                auto task = graph.emplace([] {});
+                task.succeed(previous[i % previous.size()]);
+                task.succeed(previous[(i + 1) % previous.size()]);
+                current.push_back(task);
+            }
+            std::swap(previous, current);
+        }
+        state.ResumeTiming();
+        graph.preprocess();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount));
+}
+BENCHMARK(Graph_PreprocessSwitches)->ArgsProduct({ { 1000, 50000 }, { 4 } })->Unit(benchmark::kMillisecond);
+
+/** @brief Build and clear a graph of 'range(0)' nodes, as a dynamic node does on every execution */
+static void Graph_BuildClear(benchmark::State &state)
+{
+    const auto nodeCount = static_cast<std::size_t>(state.range(0));
+    Flow::Graph graph;
+
+    for (auto _ : state) {
+        graph.clear();
+        for (auto i = 0ul; i < nodeCount; ++i)
+            graph.emplace([] {});
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount));
+}
+BENCHMARK(Graph_BuildClear)->Arg(16)->Arg(1024)->Arg(100000);
@@ -0,0 +1,52 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Benchmarks of the Scheduler
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <Kube/Flow/Scheduler.hpp>
+
+using namespace kF;
+
+static void Scheduler_Chain(benchmark::State &state)
+{
+    const auto nodeCount = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+    std::size_t counter = 0;
+
+    auto last = graph.emplace([&counter] { benchmark::DoNotOptimize(++counter); });
+    for (auto i = 1ul; i < nodeCount; ++i) {
+        auto task = graph.emplace([&counter] { benchmark::DoNotOptimize(++counter); });
+        last.precede(task);
+        last = task;
+    }
+    for (auto _ : state) {
+        scheduler.schedule(graph);
+        graph.wait();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount));
+}
+BENCHMARK(Scheduler_Chain)->ArgsProduct({ { 1, 2, 4, 8 }, { 10000 } })->UseRealTime();
+
+/** @brief Same node count as 'Scheduler_Chain' but every node goes through the task queues */
+static void Scheduler_Independent(benchmark::State &state)
+{
+    const auto nodeCount = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), nodeCount);
+    Flow::Graph graph;
+    std::atomic<std::size_t> counter = 0;
+
+    auto root = graph.emplace([&counter] { benchmark::DoNotOptimize(++counter); });
+    for (auto i = 1ul; i < nodeCount; ++i) {
+        auto task = graph.emplace([&counter] { benchmark::DoNotOptimize(++counter); });
+        root.precede(task);
+    }
+    for (auto _ : state) {
+        scheduler.schedule(graph);
+        graph.wait();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount));
+}
+BENCHMARK(Scheduler_Independent)->ArgsProduct({ { 1, 2, 4, 8 }, { 10000 } })->UseRealTime();
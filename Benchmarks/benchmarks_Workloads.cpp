@@ -0,0 +1,407 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Benchmarks of the Scheduler over common graph shapes
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include <Kube/Flow/Pipeline.hpp>
+
+using namespace kF;
+
+namespace
+{
+    /** @brief Simulate the body of a task, 'granularity' being its number of iterations */
+    void Spin(const std::size_t granularity) noexcept
+    {
+        std::size_t value = 0;
+
+        for (auto i = 0ul; i < granularity; ++i)
+            benchmark::DoNotOptimize(value += i);
+    }
+
+    /** @brief Measure the average duration of 'Spin' in nanoseconds */
+    [[nodiscard]] double SpinCost(const std::size_t granularity) noexcept
+    {
+        constexpr std::size_t Samples = 10000;
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (auto i = 0ul; i < Samples; ++i)
+            Spin(granularity);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / Samples;
+    }
+
+    /**
+     * @brief Schedule 'graph' once per iteration and report:
+     *  - items_per_second: executed tasks per second
+     *  - OverheadPerNode: worker time not spent in task bodies, per task in nanoseconds
+     */
+    template<typename Setup>
+    void Run(benchmark::State &state, Flow::Scheduler &scheduler, Flow::Graph &graph, const std::size_t nodeCount, Setup &&setup)
+    {
+        const auto granularity = static_cast<std::size_t>(state.range(1));
+        const auto workerCount = std::min<std::size_t>(scheduler.workerCount(), std::max(std::thread::hardware_concurrency(), 1u));
+        const auto spinCost = SpinCost(granularity);
+        double elapsed = 0.0;
+
+        for (auto _ : state) {
+            setup();
+            const auto begin = std::chrono::steady_clock::now();
+            scheduler.schedule(graph);
+            graph.wait();
+            elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        }
+        const auto executed = static_cast<double>(state.iterations() * nodeCount);
+        state.SetItemsProcessed(static_cast<std::int64_t>(executed));
+        state.counters["OverheadPerNode"] = std::max(elapsed * static_cast<double>(workerCount) / executed - spinCost, 0.0);
+    }
+
+    /** @brief Same as above without any setup before each iteration */
+    void Run(benchmark::State &state, Flow::Scheduler &scheduler, Flow::Graph &graph, const std::size_t nodeCount)
+        { Run(state, scheduler, graph, nodeCount, [] {}); }
+
+    /** @brief Worker counts x task granularities */
+    void Arguments(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgNames({ "workers", "granularity" })->ArgsProduct({ { 1, 2, 4, 8 }, { 0, 256 } })->UseRealTime();
+    }
+
+    /** @brief Emplace a fibonacci node, each level spawning its two sub-problems into its dynamic graph */
+    void Fibonacci(Flow::Graph &graph, const std::size_t n, const std::size_t granularity, std::atomic<std::size_t> &counter)
+    {
+        graph.emplace([n, granularity, &counter](Flow::Graph &sub) {
+            Spin(granularity);
+            counter.fetch_add(1, std::memory_order_relaxed);
+            if (n < 2)
+                return;
+            sub.clear();
+            Fibonacci(sub, n - 1, granularity, counter);
+            Fibonacci(sub, n - 2, granularity, counter);
+        });
+    }
+
+    /** @brief Fibonacci call spawning its two sub-problems as successors into the running graph */
+    void SpawnFibonacci(Flow::Graph &graph, const std::size_t n, const std::size_t granularity, std::atomic<std::size_t> &counter)
+    {
+        Spin(granularity);
+        counter.fetch_add(1, std::memory_order_relaxed);
+        if (n < 2)
+            return;
+        graph.spawn([&graph, n, granularity, &counter] { SpawnFibonacci(graph, n - 1, granularity, counter); });
+        graph.spawn([&graph, n, granularity, &counter] { SpawnFibonacci(graph, n - 2, granularity, counter); });
+    }
+}
+
+/** @brief One root releasing every node, joined back by a single sink */
+static void Workload_FanOutFanIn(benchmark::State &state)
+{
+    constexpr std::size_t Width = 4096;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), Width);
+    Flow::Graph graph;
+
+    auto root = graph.emplace([granularity] { Spin(granularity); });
+    auto sink = graph.emplace([granularity] { Spin(granularity); });
+    for (auto i = 0ul; i < Width; ++i) {
+        auto task = graph.emplace([granularity] { Spin(granularity); });
+        root.precede(task);
+        task.precede(sink);
+    }
+    Run(state, scheduler, graph, Width + 2);
+}
+BENCHMARK(Workload_FanOutFanIn)->Apply(Arguments);
+
+/** @brief Independent nodes only, every node being a root scheduled by the caller */
+static void Workload_IndependentRoots(benchmark::State &state)
+{
+    constexpr std::size_t Width = 100000;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+
+    for (auto i = 0ul; i < Width; ++i)
+        graph.emplace([granularity] { Spin(granularity); });
+    Run(state, scheduler, graph, Width);
+}
+BENCHMARK(Workload_IndependentRoots)->Apply(Arguments);
+
+/** @brief A single dependency chain, no parallelism at all */
+static void Workload_Chain(benchmark::State &state)
+{
+    constexpr std::size_t Length = 4096;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+
+    auto last = graph.emplace([granularity] { Spin(granularity); });
+    for (auto i = 1ul; i < Length; ++i) {
+        auto task = graph.emplace([granularity] { Spin(granularity); });
+        last.precede(task);
+        last = task;
+    }
+    Run(state, scheduler, graph, Length);
+}
+BENCHMARK(Workload_Chain)->Apply(Arguments);
+
+/** @brief Sum of the leaves of a complete binary tree, each inner node adding its two children */
+static void Workload_TreeReduction(benchmark::State &state)
+{
+    constexpr std::size_t LeafCount = 2048;
+    constexpr std::size_t NodeCount = LeafCount * 2 - 1;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), LeafCount);
+    Flow::Graph graph;
+    std::vector<std::uint64_t> values(NodeCount);
+    std::vector<Flow::Task> tasks;
+
+    tasks.reserve(NodeCount);
+    for (auto i = 0ul; i < NodeCount; ++i) {
+        if (i < LeafCount - 1) {
+            tasks.push_back(graph.emplace([i, granularity, &values] {
+                Spin(granularity);
+                values[i] = values[i * 2 + 1] + values[i * 2 + 2];
+            }));
+        } else {
+            tasks.push_back(graph.emplace([i, granularity, &values] {
+                Spin(granularity);
+                values[i] = i;
+            }));
+        }
+    }
+    for (auto i = 0ul; i < LeafCount - 1; ++i) {
+        tasks[i].succeed(tasks[i * 2 + 1]);
+        tasks[i].succeed(tasks[i * 2 + 2]);
+    }
+    Run(state, scheduler, graph, NodeCount);
+    benchmark::DoNotOptimize(values[0]);
+}
+BENCHMARK(Workload_TreeReduction)->Apply(Arguments);
+
+/** @brief Random DAG where each node depends on up to 3 earlier nodes (fixed seed) */
+static void Workload_RandomDAG(benchmark::State &state)
+{
+    constexpr std::size_t NodeCount = 4096;
+    constexpr std::size_t MaxDependencies = 3;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), NodeCount);
+    Flow::Graph graph;
+    std::vector<Flow::Task> tasks;
+    std::mt19937 engine(42);
+
+    tasks.reserve(NodeCount);
+    for (auto i = 0ul; i < NodeCount; ++i) {
+        tasks.push_back(graph.emplace([granularity] { Spin(granularity); }));
+        if (!i)
+            continue;
+        std::uniform_int_distribution<std::size_t> distribution(0, i - 1);
+        std::size_t chosen[MaxDependencies];
+        std::size_t count = 0;
+        for (auto j = 0ul; j < MaxDependencies; ++j) {
+            // Only distinct predecessors, a duplicated link would be joined twice
+            const auto from = distribution(engine);
+            if (std::find(chosen, chosen + count, from) != chosen + count)
+                continue;
+            chosen[count++] = from;
+            tasks[i].succeed(tasks[from]);
+        }
+    }
+    Run(state, scheduler, graph, NodeCount);
+}
+BENCHMARK(Workload_RandomDAG)->Apply(Arguments);
+
+/** @brief A root releasing many switches, each picking one of its 4 branches */
+static void Workload_Switches(benchmark::State &state)
+{
+    constexpr std::size_t SwitchCount = 1024;
+    constexpr std::size_t BranchCount = 4;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), SwitchCount);
+    Flow::Graph graph;
+    std::size_t round = 0;
+
+    auto root = graph.emplace([granularity] { Spin(granularity); });
+    for (auto i = 0ul; i < SwitchCount; ++i) {
+        auto branch = graph.emplace([i, granularity, &round]() -> std::size_t {
+            Spin(granularity);
+            return (i + round) % BranchCount;
+        });
+        root.precede(branch);
+        for (auto j = 0ul; j < BranchCount; ++j) {
+            auto task = graph.emplace([granularity] { Spin(granularity); });
+            branch.precede(task);
+        }
+    }
+    Run(state, scheduler, graph, 1 + SwitchCount * 2, [&round] { ++round; });
+}
+BENCHMARK(Workload_Switches)->Apply(Arguments);
+
+/** @brief Parallel graph nodes each running their own fan-out subgraph */
+static void Workload_NestedGraphs(benchmark::State &state)
+{
+    constexpr std::size_t GraphCount = 64;
+    constexpr std::size_t Width = 64;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), GraphCount * Width);
+    Flow::Graph graph;
+    std::vector<Flow::Graph> subgraphs(GraphCount);
+
+    auto root = graph.emplace([granularity] { Spin(granularity); });
+    for (auto &subgraph : subgraphs) {
+        for (auto i = 0ul; i < Width; ++i)
+            subgraph.emplace([granularity] { Spin(granularity); });
+        auto task = graph.emplace(subgraph);
+        root.precede(task);
+    }
+    Run(state, scheduler, graph, 1 + GraphCount * (Width + 1));
+}
+BENCHMARK(Workload_NestedGraphs)->Apply(Arguments);
+
+/** @brief Recursive fibonacci where each call is a dynamic node spawning its sub-problems */
+static void Workload_DynamicFibonacci(benchmark::State &state)
+{
+    constexpr std::size_t N = 14;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+    std::atomic<std::size_t> counter = 0;
+
+    Fibonacci(graph, N, granularity, counter);
+    scheduler.schedule(graph);
+    graph.wait();
+    Run(state, scheduler, graph, counter.load());
+}
+BENCHMARK(Workload_DynamicFibonacci)->Apply(Arguments);
+
+/** @brief Same recursion as above, each call spawning its sub-problems into the running graph instead of a nested graph */
+static void Workload_SpawnedFibonacci(benchmark::State &state)
+{
+    constexpr std::size_t N = 14;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+    std::atomic<std::size_t> counter = 0;
+
+    graph.emplace([&graph, granularity, &counter] { SpawnFibonacci(graph, N, granularity, counter); });
+    scheduler.schedule(graph);
+    graph.wait();
+    Run(state, scheduler, graph, counter.load());
+}
+BENCHMARK(Workload_SpawnedFibonacci)->Apply(Arguments);
+
+/** @brief A fan-out graph repeated by its repeat callback instead of being rescheduled */
+static void Workload_RepeatCallback(benchmark::State &state)
+{
+    constexpr std::size_t Width = 256;
+    constexpr std::size_t RepeatCount = 64;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), Width);
+    Flow::Graph graph;
+    std::size_t repeat = 0;
+
+    for (auto i = 0ul; i < Width; ++i)
+        graph.emplace([granularity] { Spin(granularity); });
+    graph.setRepeatCallback([&repeat] { return ++repeat != RepeatCount; });
+    Run(state, scheduler, graph, Width * RepeatCount, [&repeat] { repeat = 0; });
+}
+BENCHMARK(Workload_RepeatCallback)->Apply(Arguments);
+
+/** @brief Same repeated graph in pipelined mode, successive iterations overlap instead of joining in between */
+static void Workload_PipelinedRepeat(benchmark::State &state)
+{
+    constexpr std::size_t Width = 256;
+    constexpr std::size_t RepeatCount = 64;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), Width);
+    Flow::Graph graph;
+    std::size_t repeat = 0;
+
+    for (auto i = 0ul; i < Width; ++i)
+        graph.emplace([granularity] { Spin(granularity); });
+    graph.freeze();
+    graph.setRepeatMode(Flow::RepeatMode::Pipelined);
+    graph.setRepeatCallback([&repeat] { return ++repeat != RepeatCount; });
+    Run(state, scheduler, graph, Width * RepeatCount, [&repeat] { repeat = 0; });
+}
+BENCHMARK(Workload_PipelinedRepeat)->Apply(Arguments);
+
+/** @brief Stream of items through a serial, a parallel and a serial stage, with two tokens in flight per worker */
+static void Workload_PipelineStream(benchmark::State &state)
+{
+    constexpr std::size_t ItemCount = 4096;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    const auto workerCount = static_cast<std::size_t>(state.range(0));
+    Flow::Scheduler scheduler(workerCount);
+    Flow::Pipeline pipeline(static_cast<std::uint32_t>(2 * workerCount));
+
+    pipeline.addStage(Flow::StageType::SerialInOrder, [granularity](Flow::PipelineToken &token) {
+        if (token.index() == ItemCount)
+            return token.stop();
+        Spin(granularity);
+    });
+    pipeline.addStage(Flow::StageType::Parallel, [granularity](Flow::PipelineToken &) { Spin(granularity); });
+    pipeline.addStage(Flow::StageType::SerialInOrder, [granularity](Flow::PipelineToken &) { Spin(granularity); });
+    Run(state, scheduler, pipeline.graph(), 3 * ItemCount);
+}
+BENCHMARK(Workload_PipelineStream)->Apply(Arguments);
+
+/** @brief Same stream emulated by repeating a graph of three nodes per item, which serializes items */
+static void Workload_RepeatedStream(benchmark::State &state)
+{
+    constexpr std::size_t ItemCount = 4096;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)));
+    Flow::Graph graph;
+    std::size_t item = 0;
+
+    auto produce = graph.emplace([granularity] { Spin(granularity); });
+    auto transform = graph.emplace([granularity] { Spin(granularity); });
+    auto consume = graph.emplace([granularity] { Spin(granularity); });
+    produce.precede(transform);
+    transform.precede(consume);
+    graph.setRepeatCallback([&item] { return ++item != ItemCount; });
+    Run(state, scheduler, graph, 3 * ItemCount, [&item] { item = 0; });
+}
+BENCHMARK(Workload_RepeatedStream)->Apply(Arguments);
+
+/** @brief Tasks only producing notifications, drained by the benchmark thread */
+static void Workload_Notifications(benchmark::State &state)
+{
+    constexpr std::size_t NodeCount = 4096;
+    const auto granularity = static_cast<std::size_t>(state.range(1));
+    Flow::Scheduler scheduler(static_cast<std::size_t>(state.range(0)), NodeCount, NodeCount / 4);
+    Flow::Graph graph;
+    std::size_t received = 0;
+
+    for (auto i = 0ul; i < NodeCount; ++i)
+        graph.emplace([granularity] { Spin(granularity); }, [&received] { ++received; });
+    for (auto _ : state) {
+        received = 0;
+        scheduler.schedule(graph);
+        while (received != NodeCount)
+            scheduler.processNotifications();
+        graph.wait();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * NodeCount));
+}
+BENCHMARK(Workload_Notifications)->Apply(Arguments);
+
+/** @brief Construction of a graph of small lambdas whose captures don't fit into a functor */
+static void Build_CapturingNodes(benchmark::State &state)
+{
+    constexpr std::size_t Count = 1'000'000;
+    std::size_t lhs = 0, rhs = 0;
+
+    for (auto _ : state) {
+        Flow::Graph graph;
+        for (auto i = 0ul; i < Count; ++i)
+            graph.emplace([&lhs, &rhs, i] { lhs += rhs + i; });
+        benchmark::DoNotOptimize(graph.size());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * Count));
+}
+BENCHMARK(Build_CapturingNodes)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,58 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Per-thread cache of memory blocks
+ */
+
+#pragma once
+
+#include <new>
+#include <cstddef>
+
+#include <Kube/Core/Utils.hpp>
+
+namespace kF::Flow
+{
+    template<std::size_t BlockSize, std::size_t BlockAlignment, std::size_t MaxBlockCount>
+    class BlockCache;
+}
+
+/**
+ * @brief Cache of fixed size memory blocks, local to each thread
+ *  Released blocks are kept by the releasing thread to be reused without any synchronization
+ */
+template<std::size_t BlockSize, std::size_t BlockAlignment, std::size_t MaxBlockCount = 64ul>
+class kF::Flow::BlockCache
+{
+public:
+    /** @brief Get a block from the cache of the current thread or allocate a new one */
+    [[nodiscard]] static void *Allocate(void)
+    {
+        if (auto &cache = _Cache; cache.count) [[likely]]
+            return cache.blocks[--cache.count];
+        return ::operator new(BlockSize, std::align_val_t(BlockAlignment));
+    }
+
+    /** @brief Give a block back to the cache of the current thread, or free it if the cache is full */
+    static void Deallocate(void * const block) noexcept
+    {
+        if (auto &cache = _Cache; cache.count != MaxBlockCount) [[likely]]
+            cache.blocks[cache.count++] = block;
+        else
+            ::operator delete(block, std::align_val_t(BlockAlignment));
+    }
+
+private:
+    struct Cache
+    {
+        void *blocks[MaxBlockCount];
+        std::size_t count { 0ul };
+
+        ~Cache(void) noexcept
+        {
+            while (count)
+                ::operator delete(blocks[--count], std::align_val_t(BlockAlignment));
+        }
+    };
+
+    static inline thread_local Cache _Cache {};
+};
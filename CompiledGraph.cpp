@@ -0,0 +1,45 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Compiled graph
+ */
+
+#include "Scheduler.hpp"
+
+using namespace kF;
+
+Flow::PipelineState::PipelineState(const std::uint32_t count)
+{
+    joined.allocate(2u * count);
+    dependencyCounts.allocate(count);
+    iterations.allocate(count);
+}
+
+bool Flow::PipelineState::arrive(const std::uint32_t index, const std::uint64_t iteration) noexcept
+{
+    auto &counter = joined[(iteration & 1u) * iterations.size() + index];
+    // The graph may complete and be rescheduled as soon as the arrival is counted
+    const auto dependencyCount = dependencyCounts[index];
+
+    if (++counter != dependencyCount)
+        return false;
+    // No other arrival can reach this counter until the iteration of the node is completed
+    counter.store(0u, std::memory_order_relaxed);
+    iterations[index] = iteration;
+    return true;
+}
+
+Flow::CompiledGraph::CompiledGraph(const std::uint32_t count, const std::uint32_t edgeCount)
+    : nodes(static_cast<Node *>(::operator new(sizeof(Node) * count, std::align_val_t(alignof(Node))))),
+    nodeCount(count)
+{
+    offsets.allocate(count + 1u);
+    successors.allocate(edgeCount);
+    inDegrees.allocate(count);
+}
+
+Flow::CompiledGraph::~CompiledGraph(void) noexcept
+{
+    for (auto i = 0u; i < nodeCount; ++i)
+        nodes[i].~Node();
+    ::operator delete(nodes, std::align_val_t(alignof(Node)));
+}
@@ -0,0 +1,79 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Compiled graph
+ */
+
+#pragma once
+
+// This header must no be directly included, include 'Graph' instead
+
+#include <atomic>
+#include <memory>
+
+#include <Kube/Core/HeapArray.hpp>
+
+namespace kF::Flow
+{
+    struct Node;
+    struct PipelineState;
+    struct CompiledGraph;
+
+}
+
+/**
+ * @brief Counters of a frozen graph repeated in pipelined mode
+ *  Each node has one join counter per iteration parity, so that two iterations may be in flight
+ *  A node waits for its predecessors and for its own previous iteration, roots also wait for the admission of their iteration
+ *  Iteration 'k + 2' is admitted once iteration 'k' completed, so a counter is never shared by two running iterations
+ */
+struct kF::Flow::PipelineState
+{
+    Core::HeapArray<std::atomic<std::uint32_t>> joined {}; // Join counters, 'nodeCount' per iteration parity
+    Core::HeapArray<std::uint32_t> dependencyCounts {}; // Arrivals required by every node to run an iteration
+    Core::HeapArray<std::uint64_t> iterations {}; // Iteration of the last run of every node
+    alignas_cacheline std::atomic<std::uint32_t> completed[2] {}; // Joined nodes of each iteration parity
+    alignas_cacheline std::atomic<std::uint64_t> plannedEnd { 0u }; // First iteration that is not planned to run
+
+    /** @brief Allocate counters for a given amount of nodes */
+    explicit PipelineState(const std::uint32_t count);
+
+    /** @brief Count an arrival to the node of an iteration, returns true if it is ready (the iteration is then recorded) */
+    [[nodiscard]] bool arrive(const std::uint32_t index, const std::uint64_t iteration) noexcept;
+
+    /** @brief Check if an iteration is planned to run */
+    [[nodiscard]] bool planned(const std::uint64_t iteration) const noexcept
+        { return iteration < plannedEnd.load(std::memory_order_acquire); }
+};
+
+/**
+ * @brief A compiled graph holds every node of a frozen graph in a single contiguous array
+ *  Edges are stored in compressed sparse row format, as indexes into the node array
+ */
+struct kF::Flow::CompiledGraph
+{
+    Node *nodes { nullptr }; // Contiguous node array
+    std::uint32_t nodeCount { 0u }; // Number of nodes
+    Core::HeapArray<std::uint32_t> offsets {}; // Successor row offsets, 'nodeCount + 1' entries
+    Core::HeapArray<std::uint32_t> successors {}; // Successor indexes of every node
+    Core::HeapArray<std::uint32_t> inDegrees {}; // Number of predecessors of every node
+    std::unique_ptr<PipelineState> pipeline {}; // Counters of the pipelined repeat mode (null in sequential mode)
+
+    /** @brief Allocate storage for a given amount of nodes and edges (nodes are left unconstructed) */
+    CompiledGraph(const std::uint32_t count, const std::uint32_t edgeCount);
+
+    /** @brief Destroy every node and release storage */
+    ~CompiledGraph(void) noexcept;
+
+    /** @brief Get the pipeline state if the graph is repeated in pipelined mode (null otherwise) */
+    [[nodiscard]] PipelineState *pipelineState(void) const noexcept { return pipeline.get(); }
+
+    /** @brief Get the index of a node of the compiled graph */
+    [[nodiscard]] std::uint32_t indexOf(const Node * const node) const noexcept
+        { return static_cast<std::uint32_t>(node - nodes); }
+
+    /** @brief Begin / end pointers of a node successor indexes */
+    [[nodiscard]] const std::uint32_t *successorsBegin(const std::uint32_t index) const noexcept
+        { return successors.data() + offsets[index]; }
+    [[nodiscard]] const std::uint32_t *successorsEnd(const std::uint32_t index) const noexcept
+        { return successors.data() + offsets[index + 1]; }
+};
@@ -0,0 +1,105 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Coroutine node
+ */
+
+#pragma once
+
+// This header must no be directly included, include 'Scheduler' instead
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "Graph.hpp"
+
+namespace kF::Flow
+{
+    class Coroutine;
+    class Scheduler;
+
+    /** @brief Work to be spawned as a task from a coroutine, which is resumed once the work is done */
+    struct SpawnAwaitable
+    {
+        StaticFunc work;
+    };
+
+    /** @brief Spawn a work as a task from a coroutine node (co_await Flow::Spawn(work)) */
+    template<typename Work>
+    [[nodiscard]] SpawnAwaitable Spawn(Work &&work) noexcept { return SpawnAwaitable { StaticFunc(std::forward<Work>(work)) }; }
+}
+
+/**
+ * @brief Return type of the body of coroutine nodes
+ *  The body is started on a worker when the node is ready and can co_await:
+ *      - A graph, scheduled as a nested graph
+ *      - A work spawned with 'Flow::Spawn'
+ *      - Any user awaitable, which must resume the coroutine through 'Coroutine::Reschedule' instead of resuming its handle
+ *  The worker is released while the coroutine is suspended, the node completes once the body returns
+ */
+class kF::Flow::Coroutine
+{
+public:
+    struct promise_type;
+
+    /** @brief Coroutine handle */
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /** @brief Awaiter of a graph, the worker schedules the graph once the coroutine is suspended
+     *  The exception that failed the graph, if any, is rethrown into the coroutine */
+    struct GraphAwaiter
+    {
+        Graph &graph;
+        promise_type &promise;
+
+        [[nodiscard]] bool await_ready(void) const noexcept { return !graph.size(); }
+        void await_suspend(const Handle) noexcept { promise.awaitedGraph = &graph; }
+        void await_resume(void) const { if (const auto exception = graph.exception(); exception) std::rethrow_exception(exception); }
+    };
+
+    /** @brief Promise of coroutine nodes */
+    struct promise_type
+    {
+        Node *node { nullptr }; // Node running the coroutine
+        Scheduler *scheduler { nullptr }; // Scheduler running the node
+        Graph *awaitedGraph { nullptr }; // Graph to schedule once suspended
+        Graph spawned {}; // Graph holding spawned works
+        std::exception_ptr exception {}; // Exception thrown by the body
+        std::atomic<std::uint32_t> arrivals { 0u }; // Rendezvous between the suspending worker and an external resumer
+
+        [[nodiscard]] Coroutine get_return_object(void) noexcept { return Coroutine(Handle::from_promise(*this)); }
+        [[nodiscard]] std::suspend_always initial_suspend(void) const noexcept { return {}; }
+        [[nodiscard]] std::suspend_always final_suspend(void) const noexcept { return {}; }
+        void return_void(void) const noexcept {}
+        void unhandled_exception(void) noexcept { exception = std::current_exception(); }
+
+        /** @brief Await a graph */
+        [[nodiscard]] GraphAwaiter await_transform(Graph &graph) noexcept { return GraphAwaiter { graph, *this }; }
+
+        /** @brief Await a spawned work */
+        [[nodiscard]] GraphAwaiter await_transform(SpawnAwaitable &&spawn);
+
+        /** @brief Await an user awaitable */
+        template<typename Awaitable>
+        [[nodiscard]] Awaitable &&await_transform(Awaitable &&awaitable) const noexcept { return std::forward<Awaitable>(awaitable); }
+    };
+
+    /** @brief Resume a coroutine suspended on an user awaitable, from any thread */
+    static void Reschedule(const Handle handle) noexcept;
+
+
+    /** @brief Move constructor */
+    Coroutine(Coroutine &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+    /** @brief Destroy the coroutine if not released */
+    ~Coroutine(void) noexcept { if (_handle) _handle.destroy(); }
+
+    /** @brief Release the ownership of the coroutine */
+    [[nodiscard]] std::coroutine_handle<> release(void) noexcept { return std::exchange(_handle, nullptr); }
+
+private:
+    Handle _handle {};
+
+    /** @brief Construct from a handle */
+    explicit Coroutine(const Handle handle) noexcept : _handle(handle) {}
+};
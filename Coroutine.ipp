@@ -0,0 +1,20 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Coroutine node
+ */
+
+inline kF::Flow::Coroutine::GraphAwaiter kF::Flow::Coroutine::promise_type::await_transform(SpawnAwaitable &&spawn)
+{
+    spawned.clear();
+    spawned.emplace(std::move(spawn.work));
+    return GraphAwaiter { spawned, *this };
+}
+
+inline void kF::Flow::Coroutine::Reschedule(const Handle handle) noexcept
+{
+    auto &promise = handle.promise();
+
+    // The second one between the suspending worker and the resumer schedules the node again
+    if (promise.arrivals.fetch_add(1u, std::memory_order_acq_rel) == 1u)
+        promise.scheduler->schedule(Task(promise.node));
+}
@@ -0,0 +1,89 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Signal waking up the event thread
+ */
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__linux__)
+# include <poll.h>
+# include <sys/eventfd.h>
+# include <unistd.h>
+#endif
+
+#include "EventSignal.hpp"
+
+using namespace kF;
+
+Flow::EventSignal::EventSignal(void) noexcept
+{
+#if defined(__linux__)
+    _fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+Flow::EventSignal::~EventSignal(void) noexcept
+{
+#if defined(__linux__)
+    if (_fd >= 0)
+        ::close(_fd);
+#endif
+}
+
+void Flow::EventSignal::signal(void) noexcept
+{
+    // Only the producer setting the signal wakes up the event thread
+    if (_signaled.load(std::memory_order_relaxed) || _signaled.exchange(true, std::memory_order_acq_rel))
+        return;
+#if defined(__linux__)
+    if (_fd >= 0) {
+        const std::uint64_t value { 1u };
+        [[maybe_unused]] const auto written = ::write(_fd, &value, sizeof(value));
+    }
+#else
+    std::lock_guard lock(_mutex);
+    _condition.notify_all();
+#endif
+}
+
+void Flow::EventSignal::reset(void) noexcept
+{
+    // The descriptor is drained before the flag is cleared, so that the next signal always writes after it
+#if defined(__linux__)
+    if (_fd >= 0) {
+        std::uint64_t value;
+        [[maybe_unused]] const auto read = ::read(_fd, &value, sizeof(value));
+    }
+#endif
+    _signaled.store(false, std::memory_order_seq_cst);
+}
+
+bool Flow::EventSignal::waitUntil(const std::chrono::steady_clock::time_point deadline) noexcept
+{
+#if defined(__linux__)
+    while (!_signaled.load(std::memory_order_acquire)) {
+        int timeout = -1;
+        if (deadline != std::chrono::steady_clock::time_point::max()) {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0)
+                break;
+            timeout = static_cast<int>(std::min<std::int64_t>(remaining, std::numeric_limits<int>::max()));
+        }
+        // Without descriptor (creation failed), poll only sleeps and the flag is checked every millisecond
+        pollfd descriptor { fd: _fd, events: POLLIN, revents: 0 };
+        if (_fd >= 0)
+            ::poll(&descriptor, 1, timeout);
+        else
+            ::poll(nullptr, 0, timeout < 0 ? 1 : std::min(timeout, 1));
+    }
+#else
+    std::unique_lock lock(_mutex);
+    const auto signaled = [this] { return _signaled.load(std::memory_order_acquire); };
+    if (deadline == std::chrono::steady_clock::time_point::max())
+        _condition.wait(lock, signaled);
+    else
+        _condition.wait_until(lock, deadline, signaled);
+#endif
+    return _signaled.load(std::memory_order_acquire);
+}
@@ -0,0 +1,58 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Signal waking up the event thread
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#if !defined(__linux__)
+# include <condition_variable>
+# include <mutex>
+#endif
+
+namespace kF::Flow
+{
+    class EventSignal;
+}
+
+/**
+ * @brief Level-triggered signal between any number of producers and a single event thread
+ *  Only the first signal since the last reset reaches the operating system, others are a single atomic load
+ *  On Linux the signal is an eventfd that can be watched by an epoll loop
+ */
+class kF::Flow::EventSignal
+{
+public:
+    /** @brief Construct an unsignaled signal */
+    EventSignal(void) noexcept;
+
+    /** @brief Signals are bound to their owner */
+    EventSignal(const EventSignal &other) = delete;
+    EventSignal &operator=(const EventSignal &other) = delete;
+
+    /** @brief Release the file descriptor */
+    ~EventSignal(void) noexcept;
+
+    /** @brief Signal the event thread, the caller must issue a sequentially consistent fence after publishing its event */
+    void signal(void) noexcept;
+
+    /** @brief Clear the signal before consuming events, the caller must issue a sequentially consistent fence before consuming */
+    void reset(void) noexcept;
+
+    /** @brief Wait until the signal is set or the deadline is reached, returns true if signaled */
+    bool waitUntil(const std::chrono::steady_clock::time_point deadline) noexcept;
+
+    /** @brief Get a file descriptor readable while signaled (-1 if not supported) */
+    [[nodiscard]] int fd(void) const noexcept { return _fd; }
+
+private:
+    std::atomic<bool> _signaled { false };
+    int _fd { -1 };
+#if !defined(__linux__)
+    std::mutex _mutex {};
+    std::condition_variable _condition {};
+#endif
+};
@@ -8,12 +8,39 @@ set(KubeFlowSources
     ${KubeFlowDir}/Scheduler.ipp
     ${KubeFlowDir}/Worker.hpp
     ${KubeFlowDir}/Worker.cpp
+    ${KubeFlowDir}/Stats.hpp
+    ${KubeFlowDir}/Backoff.hpp
+    ${KubeFlowDir}/Coroutine.hpp
+    ${KubeFlowDir}/Coroutine.ipp
+    ${KubeFlowDir}/GraphFuture.hpp
+    ${KubeFlowDir}/GraphFuture.ipp
+    ${KubeFlowDir}/Topology.hpp
+    ${KubeFlowDir}/Topology.cpp
+    ${KubeFlowDir}/EventSignal.hpp
+    ${KubeFlowDir}/EventSignal.cpp
+    ${KubeFlowDir}/Tracer.hpp
+    ${KubeFlowDir}/Tracer.cpp
+    ${KubeFlowDir}/WorkStealingDeque.hpp
+    ${KubeFlowDir}/WorkStealingDeque.ipp
     ${KubeFlowDir}/Graph.hpp
     ${KubeFlowDir}/Graph.ipp
     ${KubeFlowDir}/Graph.cpp
     ${KubeFlowDir}/Task.hpp
     ${KubeFlowDir}/Task.ipp
     ${KubeFlowDir}/Node.hpp
+    ${KubeFlowDir}/NodeArena.hpp
+    ${KubeFlowDir}/NodeArena.ipp
+    ${KubeFlowDir}/WorkArena.hpp
+    ${KubeFlowDir}/WorkArena.ipp
+    ${KubeFlowDir}/BlockCache.hpp
+    ${KubeFlowDir}/Algorithms.hpp
+    ${KubeFlowDir}/Algorithms.ipp
+    ${KubeFlowDir}/Algorithms.cpp
+    ${KubeFlowDir}/Pipeline.hpp
+    ${KubeFlowDir}/Pipeline.ipp
+    ${KubeFlowDir}/Pipeline.cpp
+    ${KubeFlowDir}/CompiledGraph.hpp
+    ${KubeFlowDir}/CompiledGraph.cpp
 )
 
 add_library(${PROJECT_NAME} ${KubeFlowSources})
@@ -24,6 +51,11 @@ PUBLIC
     AtomicWait
 )
 
+# Warn at every graph construction call whose node work is allocated on the heap
+if(${KF_FLOW_REPORT_ALLOCATIONS})
+    target_compile_definitions(${PROJECT_NAME} PUBLIC KF_FLOW_REPORT_ALLOCATIONS)
+endif()
+
 if(${KF_TESTS})
     include(${KubeFlowDir}/Tests/FlowTests.cmake)
 endif()
@@ -3,55 +3,430 @@
  * @ Description: Graph
  */
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+
 #include "Scheduler.hpp"
 
 using namespace kF;
 
-void Flow::Graph::wait(void) noexcept
+void Flow::Graph::wait(void)
 {
-    if (running())
+    waitCompletion();
+    if (const auto exception = this->exception(); exception)
+        std::rethrow_exception(exception);
+}
+
+void Flow::Graph::waitCompletion(void) noexcept
+{
+    // The last load synchronizes with the completion of the graph, so its exception is visible
+    while (running())
         __cxx_atomic_wait(reinterpret_cast<bool *>(&_data->running), true, static_cast<int>(std::memory_order_relaxed));
 }
 
-void Flow::Graph::childrenJoined(const std::uint32_t childrenJoined) noexcept
+Flow::Node *Flow::Graph::childrenJoined(const std::uint32_t childrenJoined) noexcept
 {
     if (const auto count = _data->children.size(); (_data->joined += childrenJoined) == count) {
         _data->joined = 0;
-        if (hasRepeatCallback() && _data->repeatCallback())
+        if (repeat())
             _data->scheduler->schedule<true>(*this);
-        else {
-            setRunning(false);
-            setScheduler(nullptr);
+        else
+            return finish();
+    }
+    return nullptr;
+}
+
+Flow::Node *Flow::Graph::finish(void) noexcept
+{
+    complete();
+    // The graph may be rescheduled or destroyed as soon as it stops running
+    const auto parent = std::exchange(_data->parent, nullptr);
+    const auto scheduler = _data->scheduler;
+    // A failed nested graph fails the graph of its parent node, except coroutines which get the exception from 'co_await'
+    if (parent && _data->exception && parent->workData.index() != static_cast<std::size_t>(Node::WorkType::Coroutine))
+        parent->root->fail(_data->exception);
+    setScheduler(nullptr);
+    setRunning(false);
+    // Tasks of a graph may be scheduled directly, without any scheduler attached to the graph
+    if (scheduler) [[likely]]
+        scheduler->graphCompleted();
+    return parent;
+}
+
+void Flow::Graph::setRepeatMode(const RepeatMode mode)
+{
+    construct();
+    if (running())
+        throw std::logic_error("Flow::Graph::setRepeatMode: Can't change the repeat mode of a running graph");
+    _data->repeatMode = mode;
+    // Workers join the nodes of a graph through its pipeline state as long as it exists
+    if (mode == RepeatMode::Sequential && _data->compiled)
+        _data->compiled->pipeline.reset();
+}
+
+bool Flow::Graph::preparePipeline(void)
+{
+    if (_data->repeatMode != RepeatMode::Pipelined)
+        return false;
+    const auto compiled = _data->compiled.get();
+    if (!compiled)
+        throw std::logic_error("Flow::Graph::preparePipeline: A pipelined graph must be frozen");
+    for (auto i = 0u; i < compiled->nodeCount; ++i) {
+        if (compiled->nodes[i].workData.index() != static_cast<std::size_t>(Node::WorkType::Static))
+            throw std::logic_error("Flow::Graph::preparePipeline: A pipelined graph can only hold static nodes");
+    }
+    if (!compiled->pipeline)
+        compiled->pipeline = std::make_unique<PipelineState>(compiled->nodeCount);
+    // Dependency counts are reset on each schedule, a failed iteration may have left them anywhere
+    auto &state = *compiled->pipeline;
+    for (auto i = 0u; i < compiled->nodeCount; ++i) {
+        const auto inDegree = compiled->inDegrees[i];
+        state.dependencyCounts[i] = inDegree + (inDegree ? 1u : 2u);
+        // Iteration 0 doesn't wait for any previous iteration, its roots are ready
+        state.joined[i].store(inDegree ? 1u : 0u, std::memory_order_relaxed);
+        state.joined[compiled->nodeCount + i].store(0u, std::memory_order_relaxed);
+        state.iterations[i] = 0u;
+    }
+    state.completed[0].store(0u, std::memory_order_relaxed);
+    state.completed[1].store(0u, std::memory_order_relaxed);
+    state.plannedEnd.store(1u, std::memory_order_relaxed);
+    return true;
+}
+
+void Flow::Graph::startPipeline(void) noexcept
+{
+    const auto compiled = _data->compiled.get();
+    auto &state = *compiled->pipeline;
+
+    // Iterations are planned before their admission, so that their nodes know on join whether the next one runs
+    planIteration(state, 1u);
+    if (!state.planned(1u))
+        return;
+    planIteration(state, 2u);
+    // Roots of iteration 1 still wait for their iteration 0
+    for (const auto root : _data->roots)
+        static_cast<void>(state.arrive(compiled->indexOf(root.node()), 1u));
+}
+
+bool Flow::Graph::iterationJoined(const std::uint64_t iteration) noexcept
+{
+    auto &state = *_data->compiled->pipeline;
+    auto &completed = state.completed[iteration & 1u];
+
+    if (++completed != _data->compiled->nodeCount)
+        return false;
+    completed.store(0u, std::memory_order_relaxed);
+    // The counters of this iteration are free, the iteration after the next one may start
+    if (state.planned(iteration + 2u)) {
+        planIteration(state, iteration + 3u);
+        return true;
+    } else if (!state.planned(iteration + 1u))
+        static_cast<void>(finish());
+    return false;
+}
+
+void Flow::Graph::planIteration(PipelineState &state, const std::uint64_t iteration) noexcept
+{
+    if (state.plannedEnd.load(std::memory_order_relaxed) == iteration && repeat())
+        state.plannedEnd.store(iteration + 1u, std::memory_order_release);
+}
+
+void Flow::Graph::attachSpawnedNode(Node * const node)
+{
+    const auto worker = Worker::Current();
+    const auto current = worker ? worker->currentNode() : nullptr;
+
+    // Tasks scheduled outside of their graph don't join it, nor would the nodes they spawn
+    if (!current || current->root->_data != _data || !running()) [[unlikely]] {
+        NodeArena::DeallocateNode(node);
+        throw std::logic_error("Flow::Graph::spawn: Nodes can only be spawned by a running node of the same graph");
+    } else if (_data->compiled && _data->compiled->pipeline) [[unlikely]] {
+        NodeArena::DeallocateNode(node);
+        throw std::logic_error("Flow::Graph::spawn: Nodes can't be spawned into a pipelined graph");
+    } else if (node->workData.index() == static_cast<std::size_t>(Node::WorkType::Switch) || node->notifyFunc) [[unlikely]] {
+        NodeArena::DeallocateNode(node);
+        throw std::logic_error("Flow::Graph::spawn: A spawned node can't be a switch node nor have a notification");
+    }
+    // The current node is not joined yet, so the graph can't complete before accounting for the new node
+    --_data->joined;
+    worker->spawnNode(node);
+}
+
+void Flow::Graph::deferSuccessors(Task spawned)
+{
+    const auto worker = Worker::Current();
+
+    if (!worker || !worker->currentNode() || worker->currentNode()->root->_data != _data) [[unlikely]]
+        throw std::logic_error("Flow::Graph::deferSuccessors: Successors can only be deferred by a running node of the same graph");
+    worker->deferSuccessors(spawned.node());
+}
+
+void Flow::Graph::complete(void) noexcept
+{
+    auto completion = std::move(_data->completion);
+
+    _data->completion = CompletionFunc();
+    if (!completion) [[likely]]
+        return;
+    else if (_data->completionMode == CompletionMode::Notification) {
+        // Loop until the event thread makes room for the completion
+        for (Backoff backoff; !_data->scheduler->notifyCompletion(completion); backoff.wait());
+    } else {
+        try {
+            completion();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    }
+}
+
+bool Flow::Graph::repeat(void) noexcept
+{
+    if (!hasRepeatCallback() || cancelled())
+        return false;
+    try {
+        return _data->repeatCallback();
+    } catch (...) {
+        fail(std::current_exception());
+        return false;
+    }
+}
+
+void Flow::Graph::freeze(void)
+{
+    if (!_data || _data->compiled)
+        return;
+    waitCompletion();
+
+    auto &children = _data->children;
+    const auto nodeCount = static_cast<std::uint32_t>(children.size());
+    std::uint32_t edgeCount { 0u };
+
+    for (auto &child : children)
+        edgeCount += child->linkedTo.size();
+    auto compiled = std::make_unique<CompiledGraph>(nodeCount, edgeCount);
+
+    // Store the index of each node into its join counter, which is unused while the graph is not running
+    for (auto i = 0u; i < nodeCount; ++i)
+        children[i]->joined.store(i, std::memory_order_relaxed);
+
+    // Build compressed sparse rows
+    std::uint32_t offset { 0u };
+    for (auto i = 0u; i < nodeCount; ++i) {
+        const auto &node = *children[i].node();
+        compiled->offsets[i] = offset;
+        compiled->inDegrees[i] = node.linkedFrom.size();
+        for (const auto link : node.linkedTo)
+            compiled->successors[offset++] = link->joined.load(std::memory_order_relaxed);
+    }
+    compiled->offsets[nodeCount] = offset;
+
+    // Relocate nodes, then remap links using the indexes still stored in the old nodes
+    for (auto i = 0u; i < nodeCount; ++i)
+        new (compiled->nodes + i) Node(std::move(*children[i].node()));
+    for (auto i = 0u; i < nodeCount; ++i) {
+        auto &node = compiled->nodes[i];
+        for (auto &link : node.linkedTo)
+            link = compiled->nodes + link->joined.load(std::memory_order_relaxed);
+        for (auto &link : node.linkedFrom)
+            link = compiled->nodes + link->joined.load(std::memory_order_relaxed);
+        // The nested graph of a dynamic node moved with its node
+        if (node.workData.index() == static_cast<std::size_t>(Node::WorkType::Dynamic)) {
+            auto &dynamic = std::get<static_cast<std::size_t>(Node::WorkType::Dynamic)>(node.workData);
+            if (dynamic.graph) {
+                for (auto &child : dynamic.graph)
+                    child->root = &dynamic.graph;
+            }
         }
     }
+    for (auto i = 0u; i < nodeCount; ++i) {
+        compiled->nodes[i].joined.store(0u, std::memory_order_relaxed);
+        children[i].relocate(compiled->nodes + i);
+    }
+    _data->arena.release();
+    _data->compiled = std::move(compiled);
+    // Cached roots point to the old nodes
+    if (_data->isPreprocessed)
+        collectRoots();
 }
 
 void Flow::Graph::preprocessImpl(void) noexcept
 {
-    Core::TinyVector<const Node *> cache;
+    auto &children = _data->children;
+    const auto count = children.size();
+    const auto wordCount = (count + 63u) / 64u;
+    const bool full = !_data->isPreprocessed;
+    Core::TinyVector<std::uint32_t> stack;
+    Core::TinyVector<std::uint32_t> offsets;
+    Core::TinyVector<std::uint32_t> successors;
+    Bitset visited;
+    Bitset affected;
 
-    for (auto &node : *this) {
+    // Store the index of each node into its join counter, which is unused while the graph is not running
+    for (auto i = 0u; i < count; ++i)
+        children[i]->joined.store(i, std::memory_order_relaxed);
+    visited.resize(wordCount, 0u);
+
+    // Mark every node that can reach a modified node, their switch join counts may have changed
+    if (!full) {
+        affected.resize(wordCount, 0u);
+        Core::TinyVector<Node *> nodeStack;
+        for (const auto node : _data->dirtyNodes) {
+            const auto index = node->joined.load(std::memory_order_relaxed);
+            if (affected[index / 64u] & (1ul << (index % 64u)))
+                continue;
+            affected[index / 64u] |= 1ul << (index % 64u);
+            nodeStack.push(node);
+            while (!nodeStack.empty()) {
+                const auto current = nodeStack.back();
+                nodeStack.pop();
+                for (const auto link : current->linkedFrom) {
+                    const auto linkIndex = link->joined.load(std::memory_order_relaxed);
+                    if (auto &word = affected[linkIndex / 64u]; !(word & (1ul << (linkIndex % 64u)))) {
+                        word |= 1ul << (linkIndex % 64u);
+                        nodeStack.push(link);
+                    }
+                }
+            }
+        }
+    }
+
+    // Walk the successors as indexes stored in contiguous rows instead of chasing node pointers
+    const std::uint32_t *offsetsData;
+    const std::uint32_t *successorsData;
+    if (const auto compiled = _data->compiled.get(); compiled) {
+        offsetsData = compiled->offsets.data();
+        successorsData = compiled->successors.data();
+    } else {
+        offsets.reserve(count + 1u);
+        for (auto &child : children) {
+            offsets.push(successors.size());
+            for (const auto link : child->linkedTo)
+                successors.push(link->joined.load(std::memory_order_relaxed));
+        }
+        offsets.push(successors.size());
+        offsetsData = offsets.data();
+        successorsData = successors.data();
+    }
+
+    for (auto i = 0u; i < count; ++i) {
+        const auto node = children[i].node();
         if (node->workData.index() != static_cast<std::size_t>(Node::WorkType::Switch))
             continue;
         auto &switchTask = std::get<static_cast<std::size_t>(Node::WorkType::Switch)>(node->workData);
+        if (!full && switchTask.joinCounts.size() == node->linkedTo.size() && !(affected[i / 64u] & (1ul << (i % 64u))))
+            continue;
+        switchTask.joinCounts.clear();
         switchTask.joinCounts.reserve(node->linkedTo.size());
-        for (const auto childNode : node->linkedTo) {
-            std::size_t count { 1u };
-            cache.clear();
-            countSubChildren(*childNode, count, cache);
-            switchTask.joinCounts.push(count);
+        for (auto it = offsetsData[i], end = offsetsData[i + 1]; it != end; ++it) {
+            for (auto &word : visited)
+                word = 0u;
+            switchTask.joinCounts.push(CountReachable(successorsData[it], offsetsData, successorsData, visited, stack));
         }
     }
+
+    computeRanks(offsetsData, successorsData, visited, stack);
+    sortSuccessorsByRank();
+    collectRoots();
+
+    for (auto &child : children)
+        child->joined.store(0u, std::memory_order_relaxed);
+    _data->dirtyNodes.clear();
     _data->isPreprocessed = true;
 }
 
-void Flow::Graph::countSubChildren(const Node &node, std::size_t &count, Core::TinyVector<const Node *> &cache) noexcept
+void Flow::Graph::collectRoots(void) noexcept
+{
+    _data->roots.clear();
+    for (auto &child : _data->children) {
+        if (child->linkedFrom.empty())
+            _data->roots.push(child.node());
+    }
+    std::stable_sort(_data->roots.begin(), _data->roots.end(),
+        [](const Task lhs, const Task rhs) { return lhs.node()->rank > rhs.node()->rank; });
+}
+
+void Flow::Graph::computeRanks(const std::uint32_t * const offsets, const std::uint32_t * const successors,
+        Bitset &visited, Core::TinyVector<std::uint32_t> &stack) noexcept
+{
+    auto &children = _data->children;
+    const auto count = static_cast<std::uint32_t>(children.size());
+    Core::TinyVector<std::uint32_t> cursors;
+
+    // Depth first post-order: a node is ranked once all of its successors are
+    for (auto &word : visited)
+        word = 0u;
+    cursors.resize(count, 0u);
+    for (auto i = 0u; i < count; ++i) {
+        if (visited[i / 64u] & (1ul << (i % 64u)))
+            continue;
+        visited[i / 64u] |= 1ul << (i % 64u);
+        cursors[i] = offsets[i];
+        stack.push(i);
+        while (!stack.empty()) {
+            const auto current = stack.back();
+            if (auto &cursor = cursors[current]; cursor != offsets[current + 1]) {
+                const auto link = successors[cursor++];
+                if (auto &word = visited[link / 64u]; !(word & (1ul << (link % 64u)))) {
+                    word |= 1ul << (link % 64u);
+                    cursors[link] = offsets[link];
+                    stack.push(link);
+                }
+                continue;
+            }
+            stack.pop();
+            std::uint32_t successorRank { 0u };
+            for (auto it = offsets[current], end = offsets[current + 1]; it != end; ++it)
+                successorRank = std::max(successorRank, children[successors[it]]->rank);
+            const auto node = children[current].node();
+            node->rank = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+                static_cast<std::uint64_t>(node->cost) + successorRank, std::numeric_limits<std::uint32_t>::max()));
+        }
+    }
+}
+
+void Flow::Graph::sortSuccessorsByRank(void) noexcept
 {
-    for (const auto childNode : node.linkedTo) {
-        if (cache.find(childNode) == cache.end()) {
-            ++count;
-            cache.push(childNode);
-            countSubChildren(*childNode, count, cache);
+    auto &children = _data->children;
+    const auto count = static_cast<std::uint32_t>(children.size());
+
+    // Switch nodes are skipped, the index returned by their functor refers to the order of their links
+    if (const auto compiled = _data->compiled.get(); compiled) {
+        for (auto i = 0u; i < count; ++i) {
+            if (compiled->nodes[i].workData.index() == static_cast<std::size_t>(Node::WorkType::Switch))
+                continue;
+            std::sort(compiled->successors.begin() + compiled->offsets[i], compiled->successors.begin() + compiled->offsets[i + 1],
+                [compiled](const std::uint32_t lhs, const std::uint32_t rhs) { return compiled->nodes[lhs].rank < compiled->nodes[rhs].rank; });
+        }
+    } else {
+        for (auto &child : children) {
+            if (child->workData.index() == static_cast<std::size_t>(Node::WorkType::Switch))
+                continue;
+            std::sort(child->linkedTo.begin(), child->linkedTo.end(),
+                [](const Node * const lhs, const Node * const rhs) { return lhs->rank < rhs->rank; });
         }
     }
-}
\ No newline at end of file
+}
+
+std::size_t Flow::Graph::CountReachable(const std::uint32_t index, const std::uint32_t * const offsets,
+        const std::uint32_t * const successors, Bitset &visited, Core::TinyVector<std::uint32_t> &stack) noexcept
+{
+    std::size_t count { 1u };
+
+    visited[index / 64u] |= 1ul << (index % 64u);
+    stack.push(index);
+    while (!stack.empty()) {
+        const auto current = stack.back();
+        stack.pop();
+        for (auto it = offsets[current], end = offsets[current + 1]; it != end; ++it) {
+            const auto link = successors[it];
+            if (auto &word = visited[link / 64u]; !(word & (1ul << (link % 64u)))) {
+                word |= 1ul << (link % 64u);
+                ++count;
+                stack.push(link);
+            }
+        }
+    }
+    return count;
+}
@@ -5,18 +5,22 @@
 
 #pragma once
 
+#include <exception>
 #include <thread>
 #include <memory>
-#include <memory_resource>
 
 #include <Kube/Core/Assert.hpp>
 #include <Kube/Core/Vector.hpp>
 
 #include "Task.hpp"
+#include "NodeArena.hpp"
+#include "WorkArena.hpp"
 
 namespace kF::Flow
 {
     struct NodeInstance;
+    struct CompiledGraph;
+    struct PipelineState;
     class Graph;
 
     class Scheduler;
@@ -32,12 +36,28 @@ public:
         std::atomic<std::uint32_t> joined { 0 }; // Number of joined nodes
         std::atomic<std::uint16_t> sharedCount { 1 }; // Number of shared graph instances
         std::atomic<bool> running { false }; // True if the graph is already processing
-        bool isPreprocessed { false }; // True if the graph is already processing
+        bool isPreprocessed { false }; // False if the graph needs a full preprocessing
         Scheduler *scheduler { nullptr }; // The scheduler that ran the graph
         Core::Functor<bool(void)> repeatCallback {}; // On true returned, it will immediatly repeat the graph after it succeeded
+        std::unique_ptr<CompiledGraph> compiled {}; // Packed nodes and edges of a frozen graph
+        Core::TinyVector<Node *> dirtyNodes {}; // Nodes whose links changed since last preprocessing
+        Core::TinyVector<Task> roots {}; // Nodes without predecessor, collected on preprocessing
+        std::exception_ptr exception {}; // First exception thrown by a node since the graph was scheduled
+        std::atomic<bool> cancelled { false }; // If true, the work of pending nodes is skipped
+        std::atomic<bool> failed { false }; // True once an exception is captured
+        CompletionMode completionMode { CompletionMode::Worker }; // Where the completion functor is called
+        RepeatMode repeatMode { RepeatMode::Sequential }; // How iterations of a repeated graph are run
+        CompletionFunc completion {}; // Called once when the graph completes, then cleared
+        NodeArena arena {}; // Arena holding children nodes
+        WorkArena works {}; // Arena holding the works that don't fit into the functor of their node
+        Node *parent { nullptr }; // Graph or dynamic node released once the graph completes, if nested
+        bool measureCosts { false }; // If true, node costs are measured durations and ranks are updated on each schedule
+
+        /** @brief Destructor, children are destroyed before their arena */
+        ~Data(void) noexcept_destructible(Core::TinyVector<NodeInstance>);
     };
 
-    static_assert_fit_cacheline(Data);
+    static_assert_sizeof(Data, 4 * Core::CacheLineSize);
 
     /** @brief Shared pointer to data structure */
     using DataPtr = std::shared_ptr<Data>;
@@ -59,7 +79,7 @@ public:
     ~Graph(void) { release(); }
 
     /** @brief Copy assignment */
-    Graph &operator=(const Graph &other) noexcept { acquire(other); return *this; }
+    Graph &operator=(const Graph &other) noexcept { Graph copy(other); swap(copy); return *this; }
 
     /** @brief Move assignment */
     Graph &operator=(Graph &&other) noexcept { swap(other); return *this; }
@@ -82,7 +102,7 @@ public:
 
 
     /** @brief Get the running property */
-    [[nodiscard]] bool running(void) const noexcept { return _data->running.load(std::memory_order_seq_cst); }
+    [[nodiscard]] bool running(void) const noexcept { return _data && _data->running.load(std::memory_order_seq_cst); }
 
 
     /** @brief Check if the graph has a repeat callback */
@@ -93,29 +113,79 @@ public:
     void setRepeatCallback(Callback &&callback) noexcept
         { construct(); _data->repeatCallback = std::forward<Callback>(callback); }
 
+    /** @brief Set how the iterations of the graph are run (the graph must not be running)
+     *  In pipelined mode, the graph must be frozen, top-level and only hold static nodes
+     *  Two iterations may then be in flight: a node runs iteration 'k + 1' once it ran 'k' and its predecessors ran 'k + 1'
+     *  The repeat callback is called ahead of time, iteration 'k + 1' is decided when iteration 'k' starts */
+    void setRepeatMode(const RepeatMode mode);
 
-    /** @brief Emplace a node in the graph */
+    /** @brief Get how the iterations of the graph are run */
+    [[nodiscard]] RepeatMode repeatMode(void) const noexcept { return _data ? _data->repeatMode : RepeatMode::Sequential; }
+
+
+    /** @brief Emplace a node in the graph
+     *  Works too large for the functor of the node are constructed into the graph with their concrete type (see 'EmplacedWorkStorage') */
     template<typename ...Args>
     Task emplace(Args &&...args);
 
+    /** @brief Emplace a node into the running graph, from the work of one of its nodes (the current node)
+     *  The spawned node runs once the work of the current node returns and its spawned predecessors are done
+     *  It may only be linked to other nodes spawned by the current node, before the current node returns
+     *  Spawned nodes can't be switch nodes nor have a notification, they are not children of the graph and are released once done */
+    template<typename ...Args>
+    Task spawn(Args &&...args);
+
+    /** @brief Make the successors of the current node also wait for one of the nodes it spawned
+     *  Recursive expansions use it to hold their successors until the whole expansion is done */
+    void deferSuccessors(Task spawned);
+
+
+    /** @brief Measure the duration of every node (in nanoseconds) to use it as its cost, overriding cost hints
+     *  Ranks are updated each time the graph is scheduled, repeated runs only use the ranks of their first run */
+    void setCostMeasurement(const bool measure) noexcept { construct(); _data->measureCosts = measure; }
+
+    /** @brief Check if node costs are measured */
+    [[nodiscard]] bool measuringCosts(void) const noexcept { return _data && _data->measureCosts; }
+
+
+    /** @brief Wait for the graph to be executed, then rethrow the exception that cancelled it, if any */
+    void wait(void);
+
+
+    /** @brief Skip the work of every node not yet started, the graph still completes and 'wait' returns normally
+     *  Running nested graphs complete normally, but the nodes that follow them are skipped */
+    void cancel(void) noexcept { if (_data) _data->cancelled.store(true, std::memory_order_release); }
+
+    /** @brief Check if the graph was cancelled since it was scheduled (by 'cancel' or by an exception) */
+    [[nodiscard]] bool cancelled(void) const noexcept { return _data && _data->cancelled.load(std::memory_order_acquire); }
 
-    /** @brief Wait for the graph to be executed */
-    void wait(void) noexcept;
+    /** @brief Get the exception thrown by a node since the graph was scheduled (null if none) */
+    [[nodiscard]] std::exception_ptr exception(void) const noexcept { return _data ? _data->exception : nullptr; }
 
 
-    /** @brief Clear every node link (node are still valid) */
-    void clearLinks(void) noexcept;
+    /** @brief Clear every node link (node are still valid), throws if the graph is frozen */
+    void clearLinks(void);
 
-    /** @brief Clear the graph children */
+    /** @brief Clear the graph children (a frozen graph is unfrozen) */
     void clear(void);
 
 
-    /** @brief Ensure that the graph is ready to be scheduled (called by the Scheduler on schedule) */
+    /** @brief Pack every node into a single contiguous array and store edges in compressed sparse row format
+     *  Emplacing, linking or changing the work of a node of a frozen graph throws until it is cleared
+     *  Every task previously retreived from this graph is invalidated, iterate over the graph to get the packed ones */
+    void freeze(void);
+
+    /** @brief Check if the graph is frozen */
+    [[nodiscard]] bool frozen(void) const noexcept { return _data && _data->compiled; }
+
+
+    /** @brief Ensure that the graph is ready to be scheduled (called by the Scheduler on schedule)
+     *  Only switch nodes that can reach a node modified since last call are processed again */
     void preprocess(void) noexcept;
 
 
     /** @brief Get the number of owned nodes */
-    [[nodiscard]] auto size(void) const noexcept { return _data->children.size(); }
+    [[nodiscard]] std::size_t size(void) const noexcept { return _data ? _data->children.size() : 0ul; }
 
     /** @brief Begin / end iterators to iterate over children nodes */
     [[nodiscard]] Iterator begin(void) noexcept { return _data->children.begin(); }
@@ -128,32 +198,119 @@ public:
      *  Reserved for internal use ! */
     void setRunning(const bool running) noexcept;
 
-    /** @brief Get the joined property
+    /** @brief Get the joined property (joins held by workers are not counted yet)
      *  Reserved for internal use ! */
     [[nodiscard]] std::uint32_t joined(void) const noexcept { return _data->joined.load(std::memory_order_seq_cst); }
 
     /** @brief Callback that increment join count (to know when graph is done)
+     *  If this call completes a nested graph, its parent node is returned so that its successors get released
+     *  Reserved for internal use ! */
+    [[nodiscard]] Node *childJoined(void) noexcept { return childrenJoined(1); }
+    [[nodiscard]] Node *childrenJoined(const std::uint32_t childrenJoined) noexcept;
+
+    /** @brief Expect more joins before the graph completes, for children scheduled again by a running child that hasn't joined yet
+     *  Reserved for internal use ! */
+    void childrenRescheduled(const std::uint32_t count) noexcept { _data->joined -= count; }
+
+    /** @brief Check that a graph in pipelined mode can be scheduled and reset its counters, returns false in sequential mode
+     *  Reserved for internal use ! */
+    [[nodiscard]] bool preparePipeline(void);
+
+    /** @brief Plan the first iterations of a pipelined graph, its roots are then scheduled like those of any graph
+     *  Reserved for internal use ! */
+    void startPipeline(void) noexcept;
+
+    /** @brief Callback that increment the join count of an iteration of a pipelined graph
+     *  Returns true if the completed iteration lets 'iteration + 2' start, its roots must then be admitted by the caller
+     *  Reserved for internal use ! */
+    [[nodiscard]] bool iterationJoined(const std::uint64_t iteration) noexcept;
+
+    /** @brief Set the node to release once the graph completes
      *  Reserved for internal use ! */
-    void childJoined(void) noexcept { childrenJoined(1); }
-    void childrenJoined(const std::uint32_t childrenJoined) noexcept;
+    void setParent(Node * const parent) noexcept { _data->parent = parent; }
 
     /** @brief Set the scheduler property
      *  Reserved for internal use ! */
     void setScheduler(Scheduler * const scheduler) noexcept { _data->scheduler = scheduler; }
 
+    /** @brief Notify that the links or the work of a child node changed
+     *  Reserved for internal use ! */
+    void invalidate(Node * const node) noexcept;
+
+    /** @brief Capture the exception thrown by a node and cancel the graph, only the first exception is kept
+     *  Reserved for internal use ! */
+    void fail(const std::exception_ptr exception) noexcept;
+
+    /** @brief Reset the cancellation state before scheduling the graph
+     *  Reserved for internal use ! */
+    void resetCancellation(void) noexcept;
+
+    /** @brief Set the functor called once the graph completes (the graph must not be running)
+     *  Reserved for internal use ! */
+    void setCompletion(CompletionFunc &&completion, const CompletionMode mode) noexcept
+        { construct(); _data->completion = std::move(completion); _data->completionMode = mode; }
+
+    /** @brief Get the nodes without predecessor, only valid once preprocessed
+     *  Reserved for internal use ! */
+    [[nodiscard]] const Core::TinyVector<Task> &roots(void) const noexcept { return _data->roots; }
+
+    /** @brief Get the compiled graph (null if not frozen)
+     *  Reserved for internal use ! */
+    [[nodiscard]] const CompiledGraph *compiled(void) const noexcept { return _data->compiled.get(); }
+
 private:
     Data *_data { nullptr };
 
-    static inline std::pmr::synchronized_pool_resource _Pool {};
+    /** @brief Per-thread cache of data blocks */
+    using DataCache = BlockCache<sizeof(Data), alignof(Data)>;
+
+
+    /** @brief Bitset used to mark visited nodes by index */
+    using Bitset = Core::TinyVector<std::uint64_t>;
 
+    /** @brief Construct an emplaced work into the work arena if it doesn't fit into a functor, other arguments are forwarded */
+    template<typename Arg>
+    [[nodiscard]] decltype(auto) storeWork(Arg &&arg);
 
     /** @brief Implementation of the preprocess algorithm */
     void preprocessImpl(void) noexcept;
 
-    /** @brief Count the numbr of ssubchildren of a node */
-    void countSubChildren(const Node &node, std::size_t &count, Core::TinyVector<const Node *> &cache) noexcept;
+    /** @brief Call the repeat callback unless the graph was cancelled, an exception thrown by the callback fails the graph */
+    [[nodiscard]] bool repeat(void) noexcept;
+
+    /** @brief Call or send the completion functor, an exception thrown by a worker completion fails the graph */
+    void complete(void) noexcept;
+
+    /** @brief Complete the graph and stop running, returns the parent node to release if nested */
+    [[nodiscard]] Node *finish(void) noexcept;
+
+    /** @brief Plan the next iteration of a pipelined graph (an iteration is only planned if every previous one is) */
+    void planIteration(PipelineState &state, const std::uint64_t iteration) noexcept;
+
+    /** @brief Wait for the graph to be executed, without rethrowing */
+    void waitCompletion(void) noexcept;
+
+    /** @brief Account a node spawned by the current node of the calling worker, or release it and throw if it can't be spawned */
+    void attachSpawnedNode(Node * const node);
+
+    /** @brief Collect the nodes without predecessor by descending rank, so that the shared queues start with the most critical */
+    void collectRoots(void) noexcept;
+
+    /** @brief Compute the upward rank of every node using compressed sparse rows (successors are ranked before their predecessors) */
+    void computeRanks(const std::uint32_t * const offsets, const std::uint32_t * const successors,
+            Bitset &visited, Core::TinyVector<std::uint32_t> &stack) noexcept;
+
+    /** @brief Sort the successors of every node by ascending rank, so that the last pushed (first popped) is the most critical */
+    void sortSuccessorsByRank(void) noexcept;
+
+    /** @brief Count the number of nodes reachable from a node index (including itself) using compressed sparse rows */
+    [[nodiscard]] static std::size_t CountReachable(const std::uint32_t index, const std::uint32_t * const offsets,
+            const std::uint32_t * const successors, Bitset &visited, Core::TinyVector<std::uint32_t> &stack) noexcept;
 };
 
 #include "Node.hpp" // Include the node to compile Task.ipp and Graph.ipp
+#include "CompiledGraph.hpp"
+#include "NodeArena.ipp"
+#include "WorkArena.ipp"
 #include "Task.ipp"
 #include "Graph.ipp"
\ No newline at end of file
@@ -5,8 +5,11 @@
 
 inline void kF::Flow::Graph::setRunning(const bool running) noexcept
 {
-    _data->running.store(running, std::memory_order_seq_cst);
-    __cxx_atomic_notify_all(reinterpret_cast<bool *>(&_data->running));
+    // The graph handle may be destroyed by a waiter as soon as the store is visible
+    const auto data = _data;
+
+    data->running.store(running, std::memory_order_seq_cst);
+    __cxx_atomic_notify_all(reinterpret_cast<bool *>(&data->running));
 }
 
 inline void kF::Flow::Graph::acquire(const Graph &other) noexcept
@@ -20,46 +23,117 @@ inline void kF::Flow::Graph::acquire(const Graph &other) noexcept
 inline void kF::Flow::Graph::release(void)
 {
     if (_data && --_data->sharedCount == 0u) [[unlikely]] {
-        wait();
+        waitCompletion();
         _data->~Data();
-        _Pool.deallocate(_data, sizeof(Data), alignof(Data));
+        DataCache::Deallocate(_data);
     }
 }
 
 inline void kF::Flow::Graph::construct(void) noexcept
 {
     if (!_data) [[unlikely]]
-        _data = new (_Pool.allocate(sizeof(Data), alignof(Data))) Data {};
+        _data = new (DataCache::Allocate()) Data {};
+}
+
+inline kF::Flow::Graph::Data::~Data(void) noexcept_destructible(Core::TinyVector<NodeInstance>)
+{
+    if (compiled) {
+        for (auto &child : children)
+            child.detach();
+    }
+    children.clear();
 }
 
 template<typename ...Args>
 inline kF::Flow::Task kF::Flow::Graph::emplace(Args &&...args)
 {
     construct();
-    const auto node = _data->children.push(std::forward<Args>(args)...).node();
+    if (_data->compiled) [[unlikely]]
+        throw std::logic_error("Flow::Graph::emplace: Can't emplace a node into a frozen graph");
+    const auto node = _data->children.push(_data->arena.allocate(storeWork(std::forward<Args>(args))...)).node();
     node->root = this;
-    _data->isPreprocessed = false;
+    // A node without links doesn't change the preprocessing, it is only a new root
+    if (_data->isPreprocessed)
+        _data->roots.push(node);
+    return Task(node);
+}
+
+template<typename Arg>
+inline decltype(auto) kF::Flow::Graph::storeWork(Arg &&arg)
+{
+    if constexpr (ArenaWork<Arg>)
+        return WorkReference<std::remove_cvref_t<Arg>> { _data->works.allocate(std::forward<Arg>(arg)) };
+    else {
+        ReportWorkStorage<Arg, EmplacedWorkStorage<Arg>>();
+        return std::forward<Arg>(arg);
+    }
+}
+
+template<typename ...Args>
+inline kF::Flow::Task kF::Flow::Graph::spawn(Args &&...args)
+{
+    // Spawned nodes are released by any worker, their works can't be in the arena of the graph
+    (ReportWorkStorage<Args, InlineWork<Args> ? WorkStorage::Inline : WorkStorage::Heap>(), ...);
+    const auto node = NodeArena::AllocateNode(std::forward<Args>(args)...);
+
+    attachSpawnedNode(node);
     return Task(node);
 }
 
-inline void kF::Flow::Graph::clearLinks(void) noexcept
+inline void kF::Flow::Graph::clearLinks(void)
 {
+    if (frozen()) [[unlikely]]
+        throw std::logic_error("Flow::Graph::clearLinks: Can't clear the links of a frozen graph");
     for (auto &child : *this) {
         child->linkedFrom.clear();
         child->linkedTo.clear();
     }
+    _data->isPreprocessed = false;
 }
 
 inline void kF::Flow::Graph::clear(void)
 {
     if (_data) [[likely]] {
-        wait();
-        _data->children.clear();
+        waitCompletion();
+        if (_data->compiled) {
+            for (auto &child : _data->children)
+                child.detach();
+            _data->children.clear();
+            _data->compiled.reset();
+        } else
+            _data->children.clear();
+        _data->arena.clear();
+        _data->works.clear();
+        _data->dirtyNodes.clear();
+        _data->roots.clear();
+        _data->isPreprocessed = false;
     }
 }
 
+inline void kF::Flow::Graph::invalidate(Node * const node) noexcept
+{
+    // Nothing to track if a full preprocessing is already required, spawned nodes are never preprocessed
+    if (_data->isPreprocessed && !node->spawned)
+        _data->dirtyNodes.push(node);
+}
+
+inline void kF::Flow::Graph::fail(const std::exception_ptr exception) noexcept
+{
+    // The first failing node owns the exception, it is read once the graph completes
+    if (!_data->failed.exchange(true, std::memory_order_acq_rel))
+        _data->exception = exception;
+    _data->cancelled.store(true, std::memory_order_release);
+}
+
+inline void kF::Flow::Graph::resetCancellation(void) noexcept
+{
+    _data->exception = nullptr;
+    _data->failed.store(false, std::memory_order_relaxed);
+    _data->cancelled.store(false, std::memory_order_relaxed);
+}
+
 inline void kF::Flow::Graph::preprocess(void) noexcept
 {
-    if (!_data->isPreprocessed)
+    if (!_data->isPreprocessed || !_data->dirtyNodes.empty() || _data->measureCosts)
         preprocessImpl();
 }
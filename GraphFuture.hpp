@@ -0,0 +1,62 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Future of an asynchronously scheduled graph
+ */
+
+#pragma once
+
+// This header must no be directly included, include 'Scheduler' instead
+
+#include <chrono>
+
+#include "Graph.hpp"
+
+namespace kF::Flow
+{
+    class GraphFuture;
+    class Scheduler;
+}
+
+/** @brief Lightweight handle observing the completion of a graph, returned by 'Scheduler::scheduleAsync'
+ *  The future shares the graph data, which is kept alive until the future is destroyed */
+class kF::Flow::GraphFuture
+{
+public:
+    /** @brief Default constructor, the future is invalid */
+    GraphFuture(void) noexcept = default;
+
+    /** @brief Construct a future of a scheduled graph */
+    GraphFuture(Scheduler &scheduler, const Graph &graph) noexcept : _scheduler(&scheduler), _graph(graph) {}
+
+    /** @brief Copy constructor */
+    GraphFuture(const GraphFuture &other) noexcept = default;
+
+    /** @brief Move constructor */
+    GraphFuture(GraphFuture &&other) noexcept = default;
+
+    /** @brief Copy assignment */
+    GraphFuture &operator=(const GraphFuture &other) noexcept = default;
+
+    /** @brief Move assignment */
+    GraphFuture &operator=(GraphFuture &&other) noexcept = default;
+
+    /** @brief Check if the future observes a graph */
+    [[nodiscard]] bool valid(void) const noexcept { return _scheduler != nullptr; }
+
+    /** @brief Check if the graph completed (an invalid future is always ready) */
+    [[nodiscard]] bool ready(void) const noexcept { return !_graph.running(); }
+
+    /** @brief Wait for the graph to complete, then rethrow the exception that cancelled it, if any */
+    void wait(void) { _graph.wait(); }
+
+    /** @brief Wait for the graph to complete during at most 'timeout', returns true if it completed (never rethrows) */
+    template<typename Rep, typename Period>
+    [[nodiscard]] bool waitFor(const std::chrono::duration<Rep, Period> &timeout);
+
+    /** @brief Get the exception that cancelled the graph (null if none or not yet completed) */
+    [[nodiscard]] std::exception_ptr exception(void) const noexcept { return ready() ? _graph.exception() : nullptr; }
+
+private:
+    Scheduler *_scheduler { nullptr };
+    Graph _graph {};
+};
@@ -0,0 +1,13 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Future of an asynchronously scheduled graph
+ */
+
+template<typename Rep, typename Period>
+inline bool kF::Flow::GraphFuture::waitFor(const std::chrono::duration<Rep, Period> &timeout)
+{
+    if (ready())
+        return true;
+    return _scheduler->waitUntil([this] { return ready(); },
+        std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+}
@@ -7,8 +7,9 @@
 
 // This header must no be directly included, include 'Graph' instead
 
-#include <memory_resource>
+#include <coroutine>
 #include <variant>
+#include <utility>
 
 #include <Kube/Core/FlatVector.hpp>
 #include <Kube/Core/FlatString.hpp>
@@ -41,6 +42,32 @@ namespace kF::Flow
 
     /** @brief Graph node is used to construct nested graphs */
     using GraphNode = Graph;
+
+    /** @brief Work returning a coroutine */
+    template<typename Work>
+    concept CoroutineWork = std::is_invocable_v<Work> && std::is_same_v<std::invoke_result_t<Work>, Coroutine>;
+
+    /** @brief Coroutine node holds the functor creating its coroutine and the coroutine while it is suspended */
+    struct CoroutineNode
+    {
+        CoroutineFunc func;
+        std::coroutine_handle<> handle {};
+
+        /** @brief Construct from a coroutine functor (only this exact type, so that copy checks never look into the functor) */
+        template<typename Func> requires std::is_same_v<std::remove_cvref_t<Func>, CoroutineFunc>
+        explicit CoroutineNode(Func &&coroutineFunc) noexcept : func(std::forward<Func>(coroutineFunc)) {}
+
+        /** @brief Move constructor */
+        CoroutineNode(CoroutineNode &&other) noexcept
+            : func(std::move(other.func)), handle(std::exchange(other.handle, nullptr)) {}
+
+        /** @brief Move assignment */
+        CoroutineNode &operator=(CoroutineNode &&other) noexcept
+            { func = std::move(other.func); std::swap(handle, other.handle); return *this; }
+
+        /** @brief Destroy the coroutine if it never completed */
+        ~CoroutineNode(void) noexcept { if (handle) handle.destroy(); }
+    };
 }
 
 /** @brief A node is a POD structure containing all data of a scheduled task in a graph */
@@ -51,11 +78,12 @@ struct alignas_double_cacheline kF::Flow::Node
         Static = 0,
         Dynamic,
         Switch,
-        Graph
+        Graph,
+        Coroutine
     };
 
     /** @brief Variant holding work struct */
-    using WorkData = std::variant<StaticNode, DynamicNode, SwitchNode, GraphNode>;
+    using WorkData = std::variant<StaticNode, DynamicNode, SwitchNode, GraphNode, CoroutineNode>;
 
     // Cacheline 1, frequently used members
     WorkData workData {}; // Work data variant
@@ -67,7 +95,11 @@ struct alignas_double_cacheline kF::Flow::Node
     Core::FlatString name; // Node name
     std::atomic<std::uint32_t> joined { 0 }; // Joining
     alignas(4) std::atomic<bool> bypass { 0 }; // Bypass the node as if it was executed if true
+    Priority priority { Priority::Normal }; // Ready queue level of the node
+    bool spawned { false }; // True if the node was spawned into its running graph, it is released once joined
     Graph *root { nullptr };
+    std::uint32_t cost { 1u }; // Relative cost (hinted or measured) used to compute the rank
+    std::uint32_t rank { 0u }; // Upward rank: cost of the longest path from this node to a sink
 
     /** @brief Construct a node with a work functor */
     template<typename Work>
@@ -89,6 +121,21 @@ struct alignas_double_cacheline kF::Flow::Node
     Node(Work &&work, Notify &&notify, Literal &&nodeName) noexcept
         : workData(ForwardWorkData(std::forward<Work>(work))), notifyFunc(std::forward<Notify>(notify)), name(std::forward<Literal>(nodeName)) {}
 
+    /** @brief Move constructor, only used to relocate a node that is not being processed */
+    Node(Node &&other) noexcept
+        :   workData(std::move(other.workData)),
+            linkedTo(std::move(other.linkedTo)),
+            linkedFrom(std::move(other.linkedFrom)),
+            notifyFunc(std::move(other.notifyFunc)),
+            name(std::move(other.name)),
+            joined(other.joined.load(std::memory_order_relaxed)),
+            bypass(other.bypass.load(std::memory_order_relaxed)),
+            priority(other.priority),
+            spawned(other.spawned),
+            root(other.root),
+            cost(other.cost),
+            rank(other.rank) {}
+
     /** @brief Default destructor */
     ~Node(void) = default;
 
@@ -102,6 +149,9 @@ struct alignas_double_cacheline kF::Flow::Node
                 func: std::forward<Work>(work),
                 graph: Graph()
             };
+        // A functor returning a coroutine would also convert to a static functor
+        } else if constexpr (CoroutineWork<Work>) {
+            return CoroutineNode { CoroutineFunc(std::forward<Work>(work)) };
         // If we can't directly initialize a SwitchNode but we can convert it
         } else if constexpr (std::is_same_v<SwitchFunc, Work> || std::is_constructible_v<SwitchFunc, Work>) {
             return SwitchNode { std::forward<Work>(work) };
@@ -116,22 +166,21 @@ struct alignas_double_cacheline kF::Flow::Node
 
 static_assert_fit_double_cacheline(kF::Flow::Node);
 
+/** @brief A node instance owns a node constructed into the arena of its graph (but not its memory) */
 class kF::Flow::NodeInstance
 {
 public:
     /** @brief Default constructor */
-    NodeInstance(void) = default;
+    NodeInstance(void) noexcept = default;
 
-    /** @brief Allocate constructor */
-    template<typename ...Args>
-    NodeInstance(Args &&...args)
-        : _node(Allocate(std::forward<Args>(args)...)) {}
+    /** @brief Take ownership of a constructed node */
+    explicit NodeInstance(Node * const node) noexcept : _node(node) {}
 
     /** @brief Move constructor */
     NodeInstance(NodeInstance &&other) noexcept { swap(other); }
 
     /** @brief Destroy the instance */
-    ~NodeInstance(void) noexcept_destructible(Node) { if (_node) [[likely]] Deallocate(_node); }
+    ~NodeInstance(void) noexcept_destructible(Node) { if (_node) [[likely]] _node->~Node(); }
 
     /** @brief Get node pointer */
     [[nodiscard]] Node *node(void) noexcept { return _node; }
@@ -143,19 +192,17 @@ public:
     /** @brief Swap two instances */
     void swap(NodeInstance &other) noexcept { std::swap(_node, other._node); }
 
+    /** @brief Destroy the owned node and point to a node that is not owned by the instance
+     *  The instance must be detached before its destruction */
+    void relocate(Node * const node) noexcept_destructible(Node) { if (_node) [[likely]] _node->~Node(); _node = node; }
+
+    /** @brief Forget the pointed node without destroying it */
+    void detach(void) noexcept { _node = nullptr; }
+
     /** @brief Access operator */
     [[nodiscard]] Node *operator->(void) noexcept { return _node; }
     [[nodiscard]] const Node *operator->(void) const noexcept { return _node; }
 
 private:
     Node *_node { nullptr };
-
-    static inline std::pmr::synchronized_pool_resource _Pool {};
-
-    template<typename ...Args>
-    [[nodiscard]] static inline Node *Allocate(Args &&...args)
-        { return new (_Pool.allocate(sizeof(Node), alignof(Node))) Node(std::forward<Args>(args)...); }
-
-    static inline void Deallocate(Node *node) noexcept_destructible(Node)
-        { node->~Node(); return _Pool.deallocate(node, sizeof(Node), alignof(Node)); }
 };
\ No newline at end of file
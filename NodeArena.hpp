@@ -0,0 +1,81 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Node arena
+ */
+
+#pragma once
+
+// This header must no be directly included, include 'Graph' instead
+
+#include <Kube/Core/Vector.hpp>
+
+#include "BlockCache.hpp"
+
+namespace kF::Flow
+{
+    struct Node;
+    class NodeArena;
+}
+
+/**
+ * @brief Slab arena in which the nodes of a graph are constructed
+ *  Nodes are never freed one by one, every slab is reused after 'clear' and released at arena destruction
+ *  Slabs double in size up to 'MaxSlabNodeCount' nodes and come from per-thread caches, so no lock is ever taken
+ */
+class kF::Flow::NodeArena
+{
+public:
+    /** @brief Number of nodes in the first slab */
+    static constexpr std::size_t MinSlabNodeCount { 8ul };
+
+    /** @brief Number of slab size classes (each class holds twice as many nodes as the previous one) */
+    static constexpr std::size_t SlabClassCount { 5ul };
+
+    /** @brief Maximum number of nodes in a slab */
+    static constexpr std::size_t MaxSlabNodeCount { MinSlabNodeCount << (SlabClassCount - 1ul) };
+
+    /** @brief Default constructor */
+    NodeArena(void) noexcept = default;
+
+    /** @brief Arenas are bound to their graph */
+    NodeArena(const NodeArena &other) = delete;
+    NodeArena &operator=(const NodeArena &other) = delete;
+
+    /** @brief Release every slab, nodes must have been destroyed */
+    ~NodeArena(void) noexcept { release(); }
+
+    /** @brief Construct a node into the arena */
+    template<typename ...Args>
+    [[nodiscard]] Node *allocate(Args &&...args);
+
+    /** @brief Reuse every slab from start, nodes must have been destroyed */
+    void clear(void) noexcept { _slabIndex = 0u; _used = 0u; }
+
+    /** @brief Give every slab back to the cache of the current thread, nodes must have been destroyed */
+    void release(void) noexcept;
+
+
+    /** @brief Construct a single node outside of any arena, in a block of the cache of the current thread */
+    template<typename ...Args>
+    [[nodiscard]] static Node *AllocateNode(Args &&...args);
+
+    /** @brief Destroy a node constructed by 'AllocateNode' and give its block back to the cache of the current thread */
+    static void DeallocateNode(Node * const node) noexcept;
+
+private:
+    Core::TinyVector<Node *> _slabs {};
+    std::uint32_t _slabIndex { 0u };
+    std::uint32_t _used { 0u };
+
+    /** @brief Get the node count of a slab */
+    [[nodiscard]] static constexpr std::size_t SlabNodeCount(const std::size_t slabIndex) noexcept
+        { return MinSlabNodeCount << std::min(slabIndex, SlabClassCount - 1ul); }
+
+    /** @brief Allocate / deallocate a slab of a given index */
+    [[nodiscard]] static Node *AllocateSlab(const std::size_t slabIndex);
+    static void DeallocateSlab(Node * const slab, const std::size_t slabIndex) noexcept;
+
+    /** @brief Helper used to dispatch a slab index to its block cache */
+    template<std::size_t SlabClass = 0ul, typename Functor>
+    static auto DispatchSlabClass(const std::size_t slabIndex, Functor &&functor);
+};
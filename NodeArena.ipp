@@ -0,0 +1,70 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Node arena
+ */
+
+template<typename ...Args>
+inline kF::Flow::Node *kF::Flow::NodeArena::allocate(Args &&...args)
+{
+    if (_slabIndex == _slabs.size() || _used == SlabNodeCount(_slabIndex)) [[unlikely]] {
+        if (_slabIndex != _slabs.size())
+            ++_slabIndex;
+        if (_slabIndex == _slabs.size())
+            _slabs.push(AllocateSlab(_slabIndex));
+        _used = 0u;
+    }
+    const auto node = new (_slabs[_slabIndex] + _used) Node(std::forward<Args>(args)...);
+    ++_used;
+    return node;
+}
+
+inline void kF::Flow::NodeArena::release(void) noexcept
+{
+    for (auto i = 0u; i < _slabs.size(); ++i)
+        DeallocateSlab(_slabs[i], i);
+    _slabs.clear();
+    clear();
+}
+
+template<typename ...Args>
+inline kF::Flow::Node *kF::Flow::NodeArena::AllocateNode(Args &&...args)
+{
+    using Cache = BlockCache<sizeof(Node), alignof(Node)>;
+
+    return new (Cache::Allocate()) Node(std::forward<Args>(args)...);
+}
+
+inline void kF::Flow::NodeArena::DeallocateNode(Node * const node) noexcept
+{
+    using Cache = BlockCache<sizeof(Node), alignof(Node)>;
+
+    node->~Node();
+    Cache::Deallocate(node);
+}
+
+template<std::size_t SlabClass, typename Functor>
+inline auto kF::Flow::NodeArena::DispatchSlabClass(const std::size_t slabIndex, Functor &&functor)
+{
+    using Cache = BlockCache<sizeof(Node) * (MinSlabNodeCount << SlabClass), alignof(Node)>;
+
+    if constexpr (SlabClass + 1ul == SlabClassCount)
+        return functor.template operator()<Cache>();
+    else if (slabIndex == SlabClass)
+        return functor.template operator()<Cache>();
+    else
+        return DispatchSlabClass<SlabClass + 1ul>(slabIndex, std::forward<Functor>(functor));
+}
+
+inline kF::Flow::Node *kF::Flow::NodeArena::AllocateSlab(const std::size_t slabIndex)
+{
+    return DispatchSlabClass(slabIndex, []<typename Cache>(void) {
+        return static_cast<Node *>(Cache::Allocate());
+    });
+}
+
+inline void kF::Flow::NodeArena::DeallocateSlab(Node * const slab, const std::size_t slabIndex) noexcept
+{
+    DispatchSlabClass(slabIndex, [slab]<typename Cache>(void) {
+        Cache::Deallocate(slab);
+    });
+}
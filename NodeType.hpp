@@ -12,6 +12,7 @@
 namespace kF::Flow
 {
     class Graph;
+    class Coroutine;
 
     /** @brief Static functor */
     using StaticFunc = Core::Functor<void(void)>;
@@ -22,17 +23,46 @@ namespace kF::Flow
     /** @brief Dynamic functor */
     using DynamicFunc = Core::Functor<void(Graph &)>;
 
+    /** @brief Coroutine functor, called once per execution to create the coroutine of the node */
+    using CoroutineFunc = Core::Functor<Coroutine(void)>;
+
     /** @brief Notify functor to be called on the event thread */
     using NotifyFunc = Core::Functor<void(void)>;
 
+    /** @brief Completion functor of an asynchronously scheduled graph */
+    using CompletionFunc = Core::Functor<void(void)>;
+
+    /** @brief Where the completion functor of a graph is called */
+    enum class CompletionMode : std::uint8_t {
+        Worker,         // On the worker completing the graph, right before it stops running
+        Notification    // On the event thread, through 'Scheduler::processNotifications'
+    };
+
+    /** @brief How a graph with a repeat callback runs its iterations */
+    enum class RepeatMode : std::uint8_t {
+        Sequential, // An iteration starts once the previous one completed
+        Pipelined   // A node starts its next iteration as soon as it and its predecessors are done (frozen graphs of static nodes only)
+    };
+
     /** @brief Different types of nodes */
     enum class NodeType : std::size_t {
         Static = 0ul,
         Dynamic,
         Switch,
-        Graph
+        Graph,
+        Coroutine
+    };
+
+    /** @brief Scheduling priority of a node, workers always drain higher priorities first */
+    enum class Priority : std::uint8_t {
+        High = 0u,
+        Normal,
+        Low
     };
 
+    /** @brief Number of priority levels */
+    constexpr std::size_t PriorityCount { static_cast<std::size_t>(Priority::Low) + 1ul };
+
     /** @brief Empty work placeholder */
     constexpr auto EmptyWork = []{};
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Pipeline of stages processing a stream of tokens
+ */
+
+#include "Pipeline.hpp"
+
+using namespace kF;
+
+void Flow::PipelineToken::stop(void)
+{
+    if (_stage)
+        throw std::logic_error("Flow::PipelineToken::stop: Only the first stage can stop the stream");
+    _stopped = true;
+}
+
+Flow::Pipeline::Pipeline(const std::uint32_t tokenCount)
+{
+    kFAssert(tokenCount,
+        throw std::logic_error("Flow::Pipeline: A pipeline needs at least one token"));
+    _lines.allocate(tokenCount);
+    // Every line runs once after the counters are reset, then each time one of its tokens becomes ready
+    auto start = _graph.emplace([this] { prepare(); });
+    for (auto line = 0u; line < tokenCount; ++line) {
+        _lines[line].token._line = line;
+        _lines[line].task = _graph.emplace([this, line] { runLine(line); });
+        start.precede(_lines[line].task);
+    }
+}
+
+void Flow::Pipeline::prepare(void)
+{
+    const auto lineCount = tokenCount();
+    const auto stageCount = this->stageCount();
+
+    if (!stageCount)
+        throw std::logic_error("Flow::Pipeline: A pipeline needs at least one stage");
+    if (_joined.size() != lineCount * stageCount)
+        _joined.allocate(lineCount * stageCount);
+    for (auto line = 0u; line < lineCount; ++line) {
+        auto &state = _lines[line];
+        state.token._index = 0ul;
+        state.token._stage = 0u;
+        state.token._stopped = false;
+        state.started = false;
+        for (auto stage = 0u; stage < stageCount; ++stage)
+            _joined[line * stageCount + stage].store(joinCount(line, stage), std::memory_order_relaxed);
+    }
+    // Tokens left by a failed stream are dropped
+    for (auto &stage : _stages) {
+        if (!stage.handoff)
+            continue;
+        for (std::uint32_t line; stage.handoff->lines.pop(line););
+        stage.handoff->count.store(0u, std::memory_order_relaxed);
+    }
+    _producedCount = 0ul;
+}
+
+std::uint32_t Flow::Pipeline::joinCount(const std::uint32_t line, const std::uint32_t stage) const noexcept
+{
+    // The first run of a line counts as the previous token of the line leaving the last stage
+    if (!stage)
+        return line ? 2u : 1u;
+    // The first token doesn't wait for any previous token
+    else if (!line)
+        return 1u;
+    return _stages[stage].type == StageType::SerialInOrder ? 2u : 1u;
+}
+
+void Flow::Pipeline::runLine(const std::uint32_t line)
+{
+    auto &state = _lines[line];
+
+    // Later runs of a line are only scheduled once its token is ready
+    if (!state.started) {
+        state.started = true;
+        if (!arrive(line, 0u))
+            return;
+    }
+    process(line);
+}
+
+void Flow::Pipeline::process(std::uint32_t line)
+{
+    const auto lineCount = tokenCount();
+
+    while (line != lineCount) {
+        const auto stageIndex = _lines[line].token._stage;
+        auto &stage = _stages[stageIndex];
+        // Out of order stages are run by the thread that finds them idle, other tokens are queued for it
+        if (stage.handoff) {
+            static_cast<void>(stage.handoff->lines.push(line));
+            if (stage.handoff->count.fetch_add(1u, std::memory_order_acq_rel))
+                return;
+            line = drain(stage, stageIndex);
+        } else if (runStage(stage, line, stageIndex))
+            line = complete(line, stageIndex);
+        else
+            return;
+    }
+}
+
+std::uint32_t Flow::Pipeline::drain(Stage &stage, const std::uint32_t stageIndex)
+{
+    const auto lineCount = tokenCount();
+    auto &handoff = *stage.handoff;
+    auto continued = lineCount;
+
+    do {
+        std::uint32_t line;
+        // A line is counted once queued, but the queue may still be publishing a line queued before it
+        for (Backoff backoff; !handoff.lines.pop(line); backoff.wait());
+        static_cast<void>(runStage(stage, line, stageIndex));
+        if (const auto ready = complete(line, stageIndex); ready != lineCount) {
+            if (continued != lineCount)
+                scheduleLine(continued);
+            continued = ready;
+        }
+    } while (handoff.count.fetch_sub(1u, std::memory_order_acq_rel) != 1u);
+    return continued;
+}
+
+bool Flow::Pipeline::runStage(Stage &stage, const std::uint32_t line, const std::uint32_t stageIndex)
+{
+    auto &token = _lines[line].token;
+
+    if (stageIndex) {
+        stage.func(token);
+        return true;
+    }
+    // The first stage is serial in order, it owns the produced count
+    token._index = _producedCount;
+    stage.func(token);
+    if (token._stopped)
+        return false;
+    ++_producedCount;
+    return true;
+}
+
+std::uint32_t Flow::Pipeline::complete(const std::uint32_t line, const std::uint32_t stageIndex)
+{
+    const auto lineCount = tokenCount();
+    const auto stageCount = this->stageCount();
+    const auto next = (stageIndex + 1u) % stageCount;
+    auto continued = lineCount;
+
+    // The counter is reset before any arrival of the next token, which waits for the arrivals below
+    _joined[line * stageCount + stageIndex].store(_stages[stageIndex].type == StageType::SerialInOrder ? 2u : 1u, std::memory_order_relaxed);
+    _lines[line].token._stage = next;
+    if (_stages[stageIndex].type == StageType::SerialInOrder) {
+        if (const auto nextLine = (line + 1u) % lineCount; arrive(nextLine, stageIndex))
+            continued = nextLine;
+    }
+    // The token stays on this thread, the next one is scheduled
+    if (arrive(line, next)) {
+        if (continued != lineCount)
+            scheduleLine(continued);
+        continued = line;
+    }
+    return continued;
+}
+
+bool Flow::Pipeline::arrive(const std::uint32_t line, const std::uint32_t stage) noexcept
+{
+    return _joined[line * stageCount() + stage].fetch_sub(1u, std::memory_order_acq_rel) == 1u;
+}
+
+void Flow::Pipeline::scheduleLine(const std::uint32_t line) noexcept
+{
+    // The running line hasn't joined yet, so the graph can't complete before accounting for the new run
+    _graph.childrenRescheduled(1u);
+    Worker::Current()->parent().schedule(std::span<const Task>(&_lines[line].task, 1u));
+}
@@ -0,0 +1,160 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Pipeline of stages processing a stream of tokens
+ */
+
+#pragma once
+
+#include <concepts>
+
+#include <Kube/Core/HeapArray.hpp>
+#include <Kube/Core/MPMCQueue.hpp>
+
+#include "Scheduler.hpp"
+
+namespace kF::Flow
+{
+    class Pipeline;
+    class PipelineToken;
+
+    /** @brief How a pipeline stage processes tokens */
+    enum class StageType : std::uint8_t {
+        SerialInOrder,      // One token at a time, in the order tokens were produced
+        SerialOutOfOrder,   // One token at a time, in any order
+        Parallel            // Any number of tokens at a time
+    };
+}
+
+/** @brief Token passed to the stages of a pipeline
+ *  Data of a token is stored by the user, in buffers of 'tokenCount' entries indexed by 'line' */
+class kF::Flow::PipelineToken
+{
+public:
+    /** @brief Get the index of the token in the stream */
+    [[nodiscard]] std::size_t index(void) const noexcept { return _index; }
+
+    /** @brief Get the line of the token, in [0, tokenCount[ (no other token in flight has the same line) */
+    [[nodiscard]] std::uint32_t line(void) const noexcept { return _line; }
+
+    /** @brief Get the index of the stage processing the token */
+    [[nodiscard]] std::uint32_t stage(void) const noexcept { return _stage; }
+
+    /** @brief End the stream, only the first stage can stop it
+     *  The token is dropped, tokens produced before it still go through every stage */
+    void stop(void);
+
+private:
+    friend class Pipeline;
+
+    std::size_t _index { 0ul };
+    std::uint32_t _line { 0u };
+    std::uint32_t _stage { 0u };
+    bool _stopped { false };
+};
+
+/**
+ * @brief A pipeline runs a stream of tokens through a sequence of stages, with at most 'tokenCount' tokens in flight
+ *  The first stage produces tokens until it stops the stream, it is serial and in order
+ *  A token enters a stage once it left the previous one and, for serial in order stages, once the previous token left it
+ *  Tokens are handed over through atomic join counters, out of order stages queue them into a lock-free buffer
+ *  The pipeline runs through its graph, which may be scheduled or nested like any graph and must outlive it
+ */
+class kF::Flow::Pipeline
+{
+public:
+    /** @brief Work of a stage */
+    using StageFunc = Core::Functor<void(PipelineToken &)>;
+
+    /** @brief Construct a pipeline processing at most 'tokenCount' tokens at the same time */
+    explicit Pipeline(const std::uint32_t tokenCount);
+
+    /** @brief The graph of a pipeline refers to it */
+    Pipeline(const Pipeline &other) = delete;
+    Pipeline &operator=(const Pipeline &other) = delete;
+
+    /** @brief Destructor */
+    ~Pipeline(void) noexcept = default;
+
+
+    /** @brief Append a stage (the pipeline must not be running) */
+    template<typename Func>
+        requires std::invocable<Func &, PipelineToken &>
+    void addStage(const StageType type, Func &&func);
+
+    /** @brief Get the number of stages */
+    [[nodiscard]] std::uint32_t stageCount(void) const noexcept { return static_cast<std::uint32_t>(_stages.size()); }
+
+    /** @brief Get the maximum number of tokens in flight */
+    [[nodiscard]] std::uint32_t tokenCount(void) const noexcept { return static_cast<std::uint32_t>(_lines.size()); }
+
+    /** @brief Get the number of tokens produced since the pipeline was last scheduled */
+    [[nodiscard]] std::size_t producedCount(void) const noexcept { return _producedCount; }
+
+
+    /** @brief Get the graph running the pipeline, each run processes a new stream until the first stage stops it */
+    [[nodiscard]] Graph &graph(void) noexcept { return _graph; }
+
+private:
+    /** @brief Buffer of the tokens waiting for an out of order stage, drained by the thread that makes the count non-zero */
+    struct Handoff
+    {
+        Core::MPMCQueue<std::uint32_t> lines;
+        alignas_cacheline std::atomic<std::uint32_t> count { 0u };
+
+        /** @brief Construct a buffer able to hold every line */
+        explicit Handoff(const std::uint32_t lineCount) : lines(lineCount) {}
+    };
+
+    /** @brief Stage of the pipeline */
+    struct Stage
+    {
+        StageType type { StageType::Parallel };
+        StageFunc func {};
+        std::unique_ptr<Handoff> handoff {};
+    };
+
+    /** @brief Token slot, a line processes a single token at a time */
+    struct alignas_cacheline Line
+    {
+        PipelineToken token {};
+        bool started { false }; // True once the first run of the line was counted
+        Task task {};
+    };
+
+    Graph _graph {};
+    Core::Vector<Stage> _stages {};
+    Core::HeapArray<Line> _lines {};
+    Core::HeapArray<std::atomic<std::uint32_t>> _joined {}; // Join counters of every line and stage ('line * stageCount + stage')
+    std::size_t _producedCount { 0ul };
+
+
+    /** @brief Reset every counter before a new stream */
+    void prepare(void);
+
+    /** @brief Run the line of a node of the graph */
+    void runLine(const std::uint32_t line);
+
+    /** @brief Process the stages of a line while it is ready */
+    void process(std::uint32_t line);
+
+    /** @brief Process the tokens queued for an out of order stage, returns a ready line to continue with (or 'tokenCount') */
+    [[nodiscard]] std::uint32_t drain(Stage &stage, const std::uint32_t stageIndex);
+
+    /** @brief Hand a processed token over to the next stage and to the next token, returns a ready line to continue with (or 'tokenCount')
+     *  Other ready lines are scheduled */
+    [[nodiscard]] std::uint32_t complete(const std::uint32_t line, const std::uint32_t stageIndex);
+
+    /** @brief Run a stage on the token of a line, returns false if the first stage stopped the stream */
+    [[nodiscard]] bool runStage(Stage &stage, const std::uint32_t line, const std::uint32_t stageIndex);
+
+    /** @brief Count the arrival of a line to a stage, returns true if the line is ready to run it */
+    [[nodiscard]] bool arrive(const std::uint32_t line, const std::uint32_t stage) noexcept;
+
+    /** @brief Get the initial join count of a line and stage */
+    [[nodiscard]] std::uint32_t joinCount(const std::uint32_t line, const std::uint32_t stage) const noexcept;
+
+    /** @brief Schedule another run of a line from a running line */
+    void scheduleLine(const std::uint32_t line) noexcept;
+};
+
+#include "Pipeline.ipp"
@@ -0,0 +1,19 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Pipeline of stages processing a stream of tokens
+ */
+
+template<typename Func>
+    requires std::invocable<Func &, kF::Flow::PipelineToken &>
+inline void kF::Flow::Pipeline::addStage(const StageType type, Func &&func)
+{
+    if (_graph.running())
+        throw std::logic_error("Flow::Pipeline::addStage: Can't add a stage to a running pipeline");
+    else if (_stages.empty() && type != StageType::SerialInOrder)
+        throw std::logic_error("Flow::Pipeline::addStage: The first stage produces tokens, it must be serial in order");
+    _stages.push(Stage {
+        type: type,
+        func: StageFunc(std::forward<Func>(func)),
+        handoff: type == StageType::SerialOutOfOrder ? std::make_unique<Handoff>(tokenCount()) : nullptr
+    });
+}
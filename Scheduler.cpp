@@ -3,22 +3,38 @@
  * @ Description: Task Scheduler
  */
 
+#include <algorithm>
+
 #include "Scheduler.hpp"
 
 using namespace kF;
 
-Flow::Scheduler::Scheduler(const std::size_t workerCount, const std::size_t taskQueueSize, const std::size_t notificationQueueSize)
-    : _notifications(notificationQueueSize)
+Flow::Scheduler::Scheduler(const std::size_t workerCount, const std::size_t taskQueueSize,
+        const std::size_t notificationQueueSize, const Affinity affinity)
+    :   _cache(Cache { affinity: affinity }),
+        _tasks {
+            Core::MPMCQueue<Task>(taskQueueSize),
+            Core::MPMCQueue<Task>(taskQueueSize),
+            Core::MPMCQueue<Task>(taskQueueSize)
+        },
+        _notifications(notificationQueueSize),
+        _completions(notificationQueueSize)
 {
+    static_assert(PriorityCount == 3, "Flow::Scheduler::Scheduler: Queues must be initialized for every priority level");
     auto count = workerCount;
     if (count == AutoWorkerCount)
         count = std::thread::hardware_concurrency();
     if (!count)
         count = DefaultWorkerCount;
-    _lastWorkerId = count - 1;
+    // Spinning only steals time from the producer on a single core
+    if (std::thread::hardware_concurrency() <= 1u)
+        _cache.spinCount.store(0u, std::memory_order_relaxed);
+    _notificationLanes.allocate(count, notificationQueueSize);
+    _laneResumes.allocate(count, 0ul);
     _cache.workers.allocate(count, this, taskQueueSize);
-    for (auto &worker : _cache.workers)
-        worker.start();
+    const auto cpus = placeWorkers();
+    for (auto i = 0ul; i < count; ++i)
+        _cache.workers[i].start(i, cpus[i]);
 }
 
 Flow::Scheduler::~Scheduler(void)
@@ -29,18 +45,262 @@ Flow::Scheduler::~Scheduler(void)
         worker.join();
 }
 
-bool Flow::Scheduler::steal(Flow::Task &task) noexcept
+Core::Vector<std::int32_t> Flow::Scheduler::placeWorkers(void)
+{
+    const auto count = workerCount();
+    Core::Vector<CpuLocation> locations;
+    Core::Vector<std::int32_t> cpus;
+
+    // Without pinning, workers may move at any time: every other worker is as remote as another
+    if (_cache.affinity == Affinity::Pinned) {
+        const auto order = Topology::Detect().placementOrder();
+        for (auto i = 0ul; i < count && !order.empty(); ++i)
+            locations.push(order[i % order.size()]);
+    }
+    cpus.reserve(count);
+    for (auto i = 0ul; i < count; ++i) {
+        const auto pinned = i < locations.size();
+        auto &stealOrder = _cache.workers[i].stealOrder();
+        Core::Vector<std::pair<Locality, std::uint32_t>> victims;
+        victims.reserve(count);
+        for (auto j = 0ul; j < count; ++j) {
+            if (j != i)
+                victims.push(pinned ? locations[i].localityTo(locations[j]) : Locality::Remote, static_cast<std::uint32_t>(j));
+        }
+        std::sort(victims.begin(), victims.end());
+        stealOrder.victims.allocate(victims.size());
+        for (auto j = 0u; j < victims.size(); ++j)
+            stealOrder.victims[j] = victims[j].second;
+        for (auto level = 0ul; level < LocalityCount - 1; ++level) {
+            const auto end = std::find_if(victims.begin(), victims.end(), [level](const auto &victim) {
+                return static_cast<std::size_t>(victim.first) > level;
+            });
+            stealOrder.groupEnds[level] = static_cast<std::uint32_t>(end - victims.begin());
+        }
+        stealOrder.seed = static_cast<std::uint32_t>(i + 1ul) * 0x9E3779B9u | 1u;
+        cpus.push(pinned ? static_cast<std::int32_t>(locations[i].cpu) : -1);
+    }
+    return cpus;
+}
+
+bool Flow::Scheduler::steal(Flow::Task &task, const Priority priority, Worker &thief) noexcept
+{
+    auto &order = thief.stealOrder();
+    std::uint32_t begin { 0u };
+
+    // Each locality group is exhausted before the next one, the first victim of a group is random
+    // so that workers don't all rob the same one
+    for (auto level = 0ul; level < LocalityCount; ++level) {
+        const auto end = level < LocalityCount - 1 ? order.groupEnds[level] : static_cast<std::uint32_t>(order.victims.size());
+        if (const auto count = end - begin; count) {
+            auto index = order.random() % count;
+            for (auto i = 0u; i < count; ++i) {
+                if (_cache.workers[order.victims[begin + index]].steal(task, priority))
+                    return true;
+                else if (++index == count)
+                    index = 0u;
+            }
+        }
+        begin = end;
+    }
+    return false;
+}
+
+void Flow::Scheduler::schedule(const std::span<const Task> tasks) noexcept
 {
+    const auto worker = Worker::Current();
+    const auto local = worker && &worker->parent() == this;
+    const auto prioritizedCount = std::count_if(tasks.begin(), tasks.end(),
+        [](const Task task) { return task.priority() != Priority::Normal; });
+
+    if (tasks.empty())
+        return;
+    // Counted ahead so that workers woken up by a full queue look at every level
+    if (prioritizedCount)
+        prioritizedTaskQueued(prioritizedCount);
+    if (local) {
+        for (const auto task : tasks) {
+            // Local queues only refuse a task if they failed to grow, the shared one is drained by every worker
+            if (!worker->push(task)) [[unlikely]]
+                pushSharedTask(task);
+        }
+        worker->batchPushed();
+    } else
+        injectTasks(tasks);
+    // The calling worker processes its own share
+    wakeUpIdleWorkers(tasks.size() - local);
+}
+
+void Flow::Scheduler::injectTasks(const std::span<const Task> tasks) noexcept
+{
+    std::unique_lock<std::mutex> locks[PriorityCount];
+
+    for (const auto task : tasks) {
+        const auto level = static_cast<std::size_t>(task.priority());
+        // Once a level overflowed, its next tasks are injected behind the previous ones to keep their order
+        if (!locks[level] && _tasks[level].push(task)) [[likely]]
+            continue;
+        auto &injection = _injections[level];
+        if (!locks[level])
+            locks[level] = std::unique_lock(injection.mutex);
+        injection.tasks.push(task);
+    }
+    for (auto level = 0ul; level < PriorityCount; ++level) {
+        if (!locks[level])
+            continue;
+        auto &injection = _injections[level];
+        // Published before the wake up fence so that parking workers see the injected tasks
+        injection.count.store(injection.tasks.size() - injection.head, std::memory_order_relaxed);
+    }
+}
+
+bool Flow::Scheduler::popInjectedTasks(Task &task, const Priority priority, Worker &worker) noexcept
+{
+    auto &injection = _injections[static_cast<std::size_t>(priority)];
+    std::size_t taken = 1;
+    std::size_t left;
+
+    {
+        std::lock_guard lock(injection.mutex);
+        const auto available = injection.tasks.size() - injection.head;
+        if (!available)
+            return false;
+        // Each worker takes its share of the remaining tasks, the ones past the first can be stolen from its queues
+        const auto share = (available + workerCount() - 1) / workerCount();
+        task = injection.tasks[injection.head];
+        while (taken < share && worker.push(injection.tasks[injection.head + taken]))
+            ++taken;
+        if (taken > 1)
+            worker.batchPushed();
+        injection.head += taken;
+        left = available - taken;
+        if (!left) {
+            injection.tasks.clear();
+            injection.head = 0;
+        }
+        injection.count.store(left, std::memory_order_relaxed);
+    }
+    // Woken up workers may have parked meanwhile, one of them takes the next share or steals from ours
+    if (left || taken > 1)
+        wakeUpIdleWorker();
+    return true;
+}
+
+void Flow::Scheduler::wakeUpIdleWorkers(const std::size_t count) noexcept
+{
+    // Pairs with the fence of 'hasPendingTasks' so that either we see the IDLE workers or they see our tasks
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto thiefCount = _thiefCount.load(std::memory_order_relaxed);
+    if (!_idleCount.load(std::memory_order_relaxed) || count <= thiefCount)
+        return;
+    auto remaining = count - thiefCount;
     for (auto &worker : _cache.workers) {
-        if (worker.steal(task))
+        if (worker.state() == Worker::State::IDLE && worker.tryWakeUp() && !--remaining)
+            return;
+    }
+}
+
+Flow::GraphFuture Flow::Scheduler::scheduleAsync(Graph &graph)
+{
+    schedule(graph);
+    return GraphFuture(*this, graph);
+}
+
+std::size_t Flow::Scheduler::waitAny(const std::span<const GraphFuture> futures)
+{
+    auto index = futures.size();
+
+    if (futures.empty())
+        return index;
+    static_cast<void>(waitUntil([futures, &index] {
+            index = static_cast<std::size_t>(std::find_if(futures.begin(), futures.end(), [](const auto &future) { return future.ready(); }) - futures.begin());
+            return index != futures.size();
+        }, std::chrono::steady_clock::time_point::max()));
+    return index;
+}
+
+void Flow::Scheduler::waitAll(const std::span<const GraphFuture> futures)
+{
+    static_cast<void>(waitUntil([futures] { return std::all_of(futures.begin(), futures.end(), [](const auto &future) { return future.ready(); }); },
+        std::chrono::steady_clock::time_point::max()));
+}
+
+std::size_t Flow::Scheduler::processNotifications(const std::size_t maxCount)
+{
+    std::size_t count { 0ul };
+
+    // Notifications queued from now on set the signal again
+    _notificationSignal.reset();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    try {
+        // Each lane is drained as a batch before the next one
+        for (auto &lane : _notificationLanes) {
+            for (Task task; count < maxCount && lane.pop(task); ++count)
+                task.node()->notifyFunc();
+        }
+        for (Task task; count < maxCount; ++count) {
+            if (!_notifications.pop(task)) {
+                // Workers whose lane overflowed wait for the second drain, the first may have missed their last notification
+                _notificationDrains.fetch_add(1, std::memory_order_seq_cst);
+                break;
+            }
+            task.node()->notifyFunc();
+        }
+        for (CompletionFunc completion; count < maxCount && _completions.pop(completion); ++count)
+            completion();
+    } catch (...) {
+        // Notifications left behind must keep the event thread awake
+        _notificationSignal.signal();
+        throw;
+    }
+    if (count == maxCount && hasPendingNotifications())
+        _notificationSignal.signal();
+    return count;
+}
+
+bool Flow::Scheduler::hasPendingNotifications(void) const noexcept
+{
+    for (const auto &lane : _notificationLanes) {
+        if (lane.size())
             return true;
     }
-    return false;
+    return _notifications.size() || _completions.size();
+}
+
+bool Flow::Scheduler::waitNotificationsUntil(const std::chrono::steady_clock::time_point deadline)
+{
+    while (true) {
+        // The signal may have been set by notifications that were already processed
+        _notificationSignal.reset();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasPendingNotifications())
+            return true;
+        else if (!_notificationSignal.waitUntil(deadline))
+            return hasPendingNotifications();
+    }
+}
+
+void Flow::Scheduler::enableTracing(const std::size_t eventCapacity)
+{
+    if (!_cache.tracer)
+        _cache.tracer = std::make_unique<Tracer>(workerCount(), eventCapacity);
+    _cache.tracing.store(true, std::memory_order_release);
+}
+
+Flow::SchedulerStats Flow::Scheduler::stats(void) const
+{
+    SchedulerStats stats;
+
+    stats.workers.reserve(workerCount());
+    for (const auto &worker : _cache.workers)
+        stats.total += stats.workers.push(worker.stats());
+    return stats;
 }
 
 void Flow::Scheduler::wait(void) noexcept
 {
     const auto count = workerCount();
+    Backoff backoff;
 
     while (true) {
         {
@@ -49,9 +309,9 @@ void Flow::Scheduler::wait(void) noexcept
                 if (!worker.taskCount())
                     --activeCount;
             }
-            if (!activeCount)
+            if (!activeCount && !hasPendingTasks())
                 return;
         }
-        std::this_thread::yield();
+        backoff.wait();
     }
 }
\ No newline at end of file
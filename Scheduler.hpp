@@ -5,15 +5,30 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <span>
 #include <vector>
 
 #include <Kube/Core/HeapArray.hpp>
+#include <Kube/Core/SPSCQueue.hpp>
 
 #include "Worker.hpp"
+#include "Tracer.hpp"
+#include "EventSignal.hpp"
+#include "Coroutine.hpp"
+#include "GraphFuture.hpp"
 
 namespace kF::Flow
 {
     class Scheduler;
+
+    /** @brief Tune how workers wait for new tasks */
+    struct IdlePolicy
+    {
+        std::uint32_t spinCount { Backoff::DefaultSpinCount }; // Backoff rounds spent looking for tasks before parking (0 parks right away, default on single core)
+    };
 };
 
 /** @brief Schedule graph of tasks using thread workers */
@@ -26,14 +41,17 @@ public:
     /** @brief This variable is used on hardware thread detection failure */
     static constexpr std::size_t DefaultWorkerCount { 4ul };
 
-    /** @brief Default queue size of tasks */
+    /** @brief Default queue size of tasks (initial capacity of worker queues, which grow, and capacity of the shared queues) */
     static constexpr std::size_t DefaultTaskQueueSize { 4096ul };
 
-    /** @brief Default queue size of notifications */
+    /** @brief Default queue size of notifications (per worker and for other producers) */
     static constexpr std::size_t DefaultNotificationQueueSize { 4096ul };
 
-    /** @brief Construct a set of workers and start scheduler */
-    Scheduler(const std::size_t workerCount = AutoWorkerCount, const std::size_t taskQueueSize = DefaultTaskQueueSize, const std::size_t notificationQueueSize = DefaultNotificationQueueSize);
+    /** @brief Construct a set of workers and start scheduler
+     *  With 'Affinity::Pinned', workers are spread over the physical cores of each NUMA node in turn
+     *  and steal from the workers sharing their core, node and socket before remote ones */
+    Scheduler(const std::size_t workerCount = AutoWorkerCount, const std::size_t taskQueueSize = DefaultTaskQueueSize,
+            const std::size_t notificationQueueSize = DefaultNotificationQueueSize, const Affinity affinity = Affinity::None);
 
     /** @brief Destroy and join all workers */
     ~Scheduler(void);
@@ -42,17 +60,76 @@ public:
     template<bool IsRepeating = false>
     void schedule(Graph &task);
 
-    /** @brief Schedule a task */
+    /** @brief Schedule a graph and get a future observing its completion */
+    [[nodiscard]] GraphFuture scheduleAsync(Graph &graph);
+
+    /** @brief Schedule a graph with a functor called once it completes
+     *  A functor called on a worker must not wait for the graph, an exception it throws fails the graph */
+    template<typename Callback>
+    [[nodiscard]] GraphFuture scheduleAsync(Graph &graph, Callback &&callback, const CompletionMode mode = CompletionMode::Worker);
+
+    /** @brief Wait until one of the futures is ready, returns its index (or the count of futures on timeout) */
+    std::size_t waitAny(const std::span<const GraphFuture> futures);
+    template<typename Rep, typename Period>
+    [[nodiscard]] std::size_t waitAny(const std::span<const GraphFuture> futures, const std::chrono::duration<Rep, Period> &timeout);
+
+    /** @brief Wait until every future is ready, returns false on timeout */
+    void waitAll(const std::span<const GraphFuture> futures);
+    template<typename Rep, typename Period>
+    [[nodiscard]] bool waitAll(const std::span<const GraphFuture> futures, const std::chrono::duration<Rep, Period> &timeout);
+
+    /** @brief Schedule a task into the shared queue of its priority
+     *  While the queue is full, the caller backs off and wakes up workers to drain it
+     *  A task scheduled outside of its running graph doesn't join it, its graph is never touched after its work */
     void schedule(const Task task) noexcept;
 
-    /** @brief Tries to steal a task from a busy worker (only used by workers) */
-    [[nodiscard]] bool steal(Task &task) noexcept;
+    /** @brief Schedule a batch of ready tasks, waking up as many IDLE workers as needed at once
+     *  From one of the scheduler workers, tasks go to its own queues and other workers steal them
+     *  From any other thread, tasks fill the shared queues without waiting and the rest is injected at once, workers take it in chunks */
+    void schedule(const std::span<const Task> tasks) noexcept;
+
+    /** @brief Tries to pop a task of a given priority from the shared queues, then from the injected batches (only used by workers)
+     *  A worker taking injected tasks moves its share of them into its own queues */
+    [[nodiscard]] bool pop(Task &task, const Priority priority, Worker &worker) noexcept
+    {
+        const auto level = static_cast<std::size_t>(priority);
+        return _tasks[level].pop(task) || (_injections[level].count.load(std::memory_order_relaxed) && popInjectedTasks(task, priority, worker));
+    }
+
+    /** @brief Tries to steal a task of a given priority from a busy worker other than the thief (only used by workers)
+     *  Victims are tried from the closest to the farthest, starting at a random one in each locality group */
+    [[nodiscard]] bool steal(Task &task, const Priority priority, Worker &thief) noexcept;
+
+    /** @brief Wake up a single IDLE worker, if any and if no worker is already spinning for tasks */
+    void wakeUpIdleWorker(void) noexcept;
 
-    /** @brief Tries to add a notification task to be executed on the event processing thread */
-    [[nodiscard]] bool notify(const Task task) noexcept { return _notifications.push(task); }
+    /** @brief Wake up to 'count' IDLE workers, minus the ones already spinning for tasks */
+    void wakeUpIdleWorkers(const std::size_t count) noexcept;
 
-    /** @brief Process all pending notifications on the current thread */
-    void processNotifications(void) { for (Task task; _notifications.pop(task); task.node()->notifyFunc()); }
+    /** @brief Tries to add a notification task to be executed on the event processing thread
+     *  Workers use their own lane, other producers use a shared queue: notifications of different workers are not ordered
+     *  A worker whose lane is full switches to the shared queue until the event thread processed it, keeping its notifications ordered */
+    [[nodiscard]] bool notify(const Task task) noexcept;
+
+    /** @brief Tries to add the completion functor of a graph to be executed on the event processing thread
+     *  The functor is moved only on success */
+    [[nodiscard]] bool notifyCompletion(CompletionFunc &completion) noexcept;
+
+    /** @brief Process at most 'maxCount' pending notifications and graph completions on the current thread, returns the processed count */
+    std::size_t processNotifications(const std::size_t maxCount = std::numeric_limits<std::size_t>::max());
+
+    /** @brief Check if notifications or graph completions are waiting to be processed */
+    [[nodiscard]] bool hasPendingNotifications(void) const noexcept;
+
+    /** @brief Block the event thread until notifications are pending, or 'timeout' elapsed (returns false on timeout) */
+    bool waitNotifications(void) { return waitNotificationsUntil(std::chrono::steady_clock::time_point::max()); }
+    template<typename Rep, typename Period>
+    bool waitNotifications(const std::chrono::duration<Rep, Period> &timeout)
+        { return waitNotificationsUntil(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout)); }
+
+    /** @brief Get a file descriptor readable while notifications are pending, to be watched by an event loop (-1 if not supported)
+     *  The descriptor stays readable until 'processNotifications' is called */
+    [[nodiscard]] int notificationFd(void) const noexcept { return _notificationSignal.fd(); }
 
     /** @brief All job to be terminated */
     void wait(void) noexcept;
@@ -60,16 +137,127 @@ public:
     /** @brief Get the count of worker */
     [[nodiscard]] std::size_t workerCount(void) const noexcept { return _cache.workers.size(); }
 
+    /** @brief Get the placement of the workers */
+    [[nodiscard]] Affinity affinity(void) const noexcept { return _cache.affinity; }
+
+    /** @brief Start recording worker events, each worker can hold 'eventCapacity' events before they are collected
+     *  The tracer is created on first call and kept until the scheduler is destroyed */
+    void enableTracing(const std::size_t eventCapacity = Tracer::DefaultEventCapacity);
+
+    /** @brief Stop recording worker events, recorded events are kept */
+    void disableTracing(void) noexcept { _cache.tracing.store(false, std::memory_order_relaxed); }
+
+    /** @brief Get the tracer (null if tracing was never enabled) */
+    [[nodiscard]] Tracer *tracer(void) noexcept { return _cache.tracer.get(); }
+
+    /** @brief Get / Set the policy used by workers out of tasks */
+    [[nodiscard]] IdlePolicy idlePolicy(void) const noexcept
+        { return IdlePolicy { spinCount: _cache.spinCount.load(std::memory_order_relaxed) }; }
+    void setIdlePolicy(const IdlePolicy &policy) noexcept
+        { _cache.spinCount.store(policy.spinCount, std::memory_order_relaxed); }
+
+    /** @brief Take a snapshot of the counters of every worker */
+    [[nodiscard]] SchedulerStats stats(void) const;
+
+    /** @brief Get the approximative count of IDLE workers */
+    [[nodiscard]] std::size_t idleWorkerCount(void) const noexcept { return _idleCount.load(std::memory_order_relaxed); }
+
+public:
+    /** @brief Notify that a worker switched to / from IDLE state
+     *  Reserved for internal use ! */
+    void idleWorkerJoined(void) noexcept { _idleCount.fetch_add(1, std::memory_order_seq_cst); }
+    void idleWorkerLeft(void) noexcept { _idleCount.fetch_sub(1, std::memory_order_relaxed); }
+
+    /** @brief Notify that a worker started / stopped spinning for tasks, returns the previous count of spinning workers
+     *  While a worker spins, producers don't wake up sleeping ones: the spinner wakes a sleeper once it finds a task
+     *  Reserved for internal use ! */
+    std::size_t thiefJoined(void) noexcept { return _thiefCount.fetch_add(1, std::memory_order_seq_cst); }
+    std::size_t thiefLeft(void) noexcept { return _thiefCount.fetch_sub(1, std::memory_order_seq_cst); }
+
+    /** @brief Get the number of spinning rounds of workers before parking
+     *  Reserved for internal use ! */
+    [[nodiscard]] std::uint32_t spinCount(void) const noexcept { return _cache.spinCount.load(std::memory_order_relaxed); }
+
+    /** @brief Check if the shared queues or any worker have pending tasks
+     *  Reserved for internal use ! */
+    [[nodiscard]] bool hasPendingTasks(void) const noexcept;
+
+    /** @brief Count high and low priority tasks waiting in a queue, so that workers only look at other levels when needed
+     *  The count is only a hint: it is incremented after a push and may briefly be negative
+     *  Reserved for internal use ! */
+    void prioritizedTaskQueued(const std::int64_t count = 1) noexcept { _prioritizedCount.fetch_add(count, std::memory_order_relaxed); }
+    void prioritizedTaskAcquired(void) noexcept { _prioritizedCount.fetch_sub(1, std::memory_order_relaxed); }
+    [[nodiscard]] bool hasPrioritizedTasks(void) const noexcept { return _prioritizedCount.load(std::memory_order_relaxed); }
+
+    /** @brief Wake up the threads waiting for a future, called each time a graph completes
+     *  Reserved for internal use ! */
+    void graphCompleted(void) noexcept;
+
+    /** @brief Wait until a predicate on futures is true or the deadline is reached, returns the last result of the predicate
+     *  Reserved for internal use ! */
+    template<typename Predicate>
+    [[nodiscard]] bool waitUntil(Predicate &&predicate, const std::chrono::steady_clock::time_point deadline);
+
+    /** @brief Get the tracer if tracing is enabled, else null
+     *  Reserved for internal use ! */
+    [[nodiscard]] Tracer *activeTracer(void) noexcept
+        { return _cache.tracing.load(std::memory_order_acquire) ? _cache.tracer.get() : nullptr; }
+
 private:
+    /** @brief Tasks of a priority level that didn't fit in its shared queue when scheduled by another thread */
+    struct Injection
+    {
+        std::mutex mutex {};
+        Core::Vector<Task> tasks {};
+        std::size_t head { 0 }; // Index of the first task not taken yet
+        std::atomic<std::size_t> count { 0 }; // Count of tasks not taken yet, read without locking
+    };
+
     struct Cache
     {
         Core::HeapArray<Worker> workers {};
+        std::unique_ptr<Tracer> tracer {};
+        std::atomic<bool> tracing { false };
+        std::atomic<std::uint32_t> spinCount { Backoff::DefaultSpinCount };
+        Affinity affinity { Affinity::None };
     };
 
     alignas_cacheline Cache _cache {};
-    alignas_cacheline std::atomic<std::size_t> _lastWorkerId { 0 };
-    Core::MPMCQueue<Task> _notifications;
+    alignas_cacheline std::atomic<std::size_t> _idleCount { 0 }; // Read with the thief count on each wake up attempt
+    std::atomic<std::size_t> _thiefCount { 0 };
+    alignas_cacheline std::atomic<std::int64_t> _prioritizedCount { 0 };
+    Core::MPMCQueue<Task> _tasks[PriorityCount]; // One shared queue per priority level
+    Injection _injections[PriorityCount]; // Overflow of the shared queues, one per priority level
+    Core::MPMCQueue<Task> _notifications; // Notifications of other threads and overflow of worker lanes
+    Core::MPMCQueue<CompletionFunc> _completions;
+    Core::HeapArray<Core::SPSCQueue<Task>> _notificationLanes {}; // One notification queue per worker
+    Core::HeapArray<std::size_t> _laneResumes {}; // Per worker, drain count of the shared queue from which its lane is used again
+    alignas_cacheline EventSignal _notificationSignal {};
+    std::atomic<std::size_t> _notificationDrains { 0 }; // Times the event thread found the shared notification queue empty
+    alignas_cacheline std::atomic<std::size_t> _completionWaiterCount { 0 }; // Threads waiting for a future
+    std::mutex _completionMutex {};
+    std::condition_variable _completionCondition {};
+
+    /** @brief Push a task into the shared queue of its priority, waiting for workers to make room if it is full */
+    void pushSharedTask(const Task task) noexcept;
+
+    /** @brief Push a batch of tasks into the shared queues, the tasks that don't fit are injected under a single lock per priority */
+    void injectTasks(const std::span<const Task> tasks) noexcept;
+
+    /** @brief Take a task and the share of 'worker' from the injected tasks of a priority */
+    [[nodiscard]] bool popInjectedTasks(Task &task, const Priority priority, Worker &worker) noexcept;
+
+    /** @brief Wake up the event thread after a notification was queued */
+    void notificationQueued(void) noexcept;
+
+    /** @brief Wait for notifications until the deadline */
+    bool waitNotificationsUntil(const std::chrono::steady_clock::time_point deadline);
+
+    /** @brief Assign a CPU to each worker and build their steal order, returns the CPU of each worker (negative if not pinned) */
+    [[nodiscard]] Core::Vector<std::int32_t> placeWorkers(void);
 };
 
 #include "Scheduler.ipp"
-#include "Worker.ipp"
\ No newline at end of file
+#include "Worker.ipp"
+#include "Coroutine.ipp"
+#include "GraphFuture.ipp"
\ No newline at end of file
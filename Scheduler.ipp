@@ -9,37 +9,166 @@ template<bool IsRepeating>
 inline void kF::Flow::Scheduler::schedule(Graph &graph)
 {
     if constexpr (!IsRepeating) {
-        graph.preprocess();
+        // An empty graph has no root to complete it, it is already done
+        if (!graph.size())
+            return;
         if (graph.running())
             throw std::logic_error("Flow::Scheduler::schedule: Can't schedule a graph if it is already running");
+        graph.preprocess();
+        const auto pipelined = graph.preparePipeline();
+        graph.resetCancellation();
         graph.setRunning(true);
         graph.setScheduler(this);
+        // Later iterations of a pipelined graph are admitted by the workers joining the earlier ones
+        if (pipelined)
+            graph.startPipeline();
+    }
+    schedule(graph.roots());
+}
+
+template<typename Callback>
+inline kF::Flow::GraphFuture kF::Flow::Scheduler::scheduleAsync(Graph &graph, Callback &&callback, const CompletionMode mode)
+{
+    CompletionFunc completion(std::forward<Callback>(callback));
+
+    if (graph.running())
+        throw std::logic_error("Flow::Scheduler::scheduleAsync: Can't schedule a graph if it is already running");
+    // An empty graph is already complete, its functor is called or sent right away
+    if (!graph.size()) {
+        if (mode == CompletionMode::Notification)
+            for (Backoff backoff; !notifyCompletion(completion); backoff.wait());
+        else
+            completion();
+        return GraphFuture(*this, graph);
     }
-    for (auto &child : graph) {
-        if (child->linkedFrom.empty())
-            schedule(Task(child.node()));
+    graph.setCompletion(std::move(completion), mode);
+    return scheduleAsync(graph);
+}
+
+template<typename Rep, typename Period>
+inline std::size_t kF::Flow::Scheduler::waitAny(const std::span<const GraphFuture> futures, const std::chrono::duration<Rep, Period> &timeout)
+{
+    auto index = futures.size();
+
+    static_cast<void>(waitUntil([futures, &index] {
+            index = static_cast<std::size_t>(std::find_if(futures.begin(), futures.end(), [](const auto &future) { return future.ready(); }) - futures.begin());
+            return index != futures.size();
+        }, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout)));
+    return index;
+}
+
+template<typename Rep, typename Period>
+inline bool kF::Flow::Scheduler::waitAll(const std::span<const GraphFuture> futures, const std::chrono::duration<Rep, Period> &timeout)
+{
+    return waitUntil([futures] { return std::all_of(futures.begin(), futures.end(), [](const auto &future) { return future.ready(); }); },
+        std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+}
+
+template<typename Predicate>
+inline bool kF::Flow::Scheduler::waitUntil(Predicate &&predicate, const std::chrono::steady_clock::time_point deadline)
+{
+    bool result { true };
+
+    // Pairs with 'graphCompleted': either the predicate sees the completion or the completing worker sees this waiter
+    _completionWaiterCount.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock lock(_completionMutex);
+        if (deadline == std::chrono::steady_clock::time_point::max())
+            _completionCondition.wait(lock, predicate);
+        else
+            result = _completionCondition.wait_until(lock, deadline, predicate);
     }
+    _completionWaiterCount.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+}
+
+inline void kF::Flow::Scheduler::graphCompleted(void) noexcept
+{
+    if (!_completionWaiterCount.load(std::memory_order_seq_cst)) [[likely]]
+        return;
+    std::lock_guard lock(_completionMutex);
+    _completionCondition.notify_all();
 }
 
 inline void kF::Flow::Scheduler::schedule(const Task task) noexcept
 {
-    const auto count = workerCount();
-    auto id = _lastWorkerId.load(std::memory_order_relaxed);
-    std::size_t targetId;
-
-    while (true) {
-        while (true) {
-            targetId = id + 1;
-            if (targetId == count) [[unlikely]]
-                targetId = 0;
-            if (_lastWorkerId.compare_exchange_weak(id, targetId, std::memory_order_relaxed)) [[likely]]
-                break;
-        }
-        auto &worker = _cache.workers[targetId];
-        if (worker.push(task)) {
-            if (worker.state() == Worker::State::IDLE)
-                worker.wakeUp(Worker::State::Running);
-            break;
-        }
-    }
-}
\ No newline at end of file
+    // A queued node may run and be released right away, it isn't read once pushed
+    const auto priority = task.priority();
+
+    pushSharedTask(task);
+    if (priority != Priority::Normal)
+        prioritizedTaskQueued();
+    wakeUpIdleWorker();
+}
+
+inline void kF::Flow::Scheduler::pushSharedTask(const Task task) noexcept
+{
+    auto &queue = _tasks[static_cast<std::size_t>(task.priority())];
+
+    // Worker queues grow instead of waiting, so workers always come back to drain the shared queues
+    for (Backoff backoff; !queue.push(task); backoff.wait()) [[unlikely]]
+        wakeUpIdleWorkers(workerCount());
+}
+
+inline bool kF::Flow::Scheduler::notify(const Task task) noexcept
+{
+    const auto worker = Worker::Current();
+
+    if (!worker || &worker->parent() != this) {
+        if (!_notifications.push(task))
+            return false;
+    } else if (auto &resume = _laneResumes[worker->id()];
+            _notificationDrains.load(std::memory_order_seq_cst) < resume || !_notificationLanes[worker->id()].push(task)) {
+        if (!_notifications.push(task))
+            return false;
+        // Lanes are processed first, the worker stays on the shared queue until its notifications there are processed
+        resume = _notificationDrains.load(std::memory_order_seq_cst) + 2;
+    }
+    notificationQueued();
+    return true;
+}
+
+inline bool kF::Flow::Scheduler::notifyCompletion(CompletionFunc &completion) noexcept
+{
+    if (!_completions.push(std::move(completion)))
+        return false;
+    notificationQueued();
+    return true;
+}
+
+inline void kF::Flow::Scheduler::notificationQueued(void) noexcept
+{
+    // Pairs with the fence of 'processNotifications' so that either the event thread sees the notification or we see the reset signal
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _notificationSignal.signal();
+}
+
+inline void kF::Flow::Scheduler::wakeUpIdleWorker(void) noexcept
+{
+    // Pairs with the fence of 'hasPendingTasks' so that either we see the IDLE worker or it sees our task
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!_idleCount.load(std::memory_order_relaxed) || _thiefCount.load(std::memory_order_relaxed)) [[likely]]
+        return;
+    for (auto &worker : _cache.workers) {
+        if (worker.state() == Worker::State::IDLE && worker.tryWakeUp())
+            return;
+    }
+}
+
+inline bool kF::Flow::Scheduler::hasPendingTasks(void) const noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (const auto &queue : _tasks) {
+        if (queue.size())
+            return true;
+    }
+    for (const auto &injection : _injections) {
+        if (injection.count.load(std::memory_order_relaxed))
+            return true;
+    }
+    for (const auto &worker : _cache.workers) {
+        if (worker.taskCount())
+            return true;
+    }
+    return false;
+}
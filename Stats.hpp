@@ -0,0 +1,113 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Scheduler statistics
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+#include <Kube/Core/Vector.hpp>
+
+#include "NodeType.hpp"
+
+namespace kF::Flow
+{
+    struct WorkerStats;
+    struct WorkerCounters;
+    struct SchedulerStats;
+
+    /** @brief Number of node types */
+    constexpr std::size_t NodeTypeCount { static_cast<std::size_t>(NodeType::Coroutine) + 1ul };
+}
+
+/** @brief Snapshot of the counters of a worker, every counter is monotonic */
+struct kF::Flow::WorkerStats
+{
+    std::uint64_t executedTasks[NodeTypeCount] {}; // Number of executed tasks, indexed by node type
+    std::uint64_t steals { 0u }; // Number of tasks stolen from other workers
+    std::uint64_t failedSteals { 0u }; // Number of times no task could be stolen
+    std::uint64_t wakeUps { 0u }; // Number of times the worker was woken up
+    std::uint64_t idleNanoseconds { 0u }; // Time spent sleeping
+    std::uint64_t notificationRetries { 0u }; // Number of times the notification queue was full
+    std::uint64_t queueHighWater { 0u }; // Highest number of tasks observed in the local queue
+
+    /** @brief Get the total number of executed tasks */
+    [[nodiscard]] std::uint64_t executedTaskCount(void) const noexcept;
+
+    /** @brief Accumulate the counters of another worker (the high water mark is the maximum of both) */
+    WorkerStats &operator+=(const WorkerStats &other) noexcept;
+};
+
+/**
+ * @brief Live counters of a worker
+ *  Only written by their worker using plain load / store, so they never take a lock nor a read-modify-write
+ */
+struct alignas_double_cacheline kF::Flow::WorkerCounters
+{
+    std::atomic<std::uint64_t> executedTasks[NodeTypeCount] {};
+    std::atomic<std::uint64_t> steals { 0u };
+    std::atomic<std::uint64_t> failedSteals { 0u };
+    std::atomic<std::uint64_t> wakeUps { 0u };
+    std::atomic<std::uint64_t> idleNanoseconds { 0u };
+    std::atomic<std::uint64_t> notificationRetries { 0u };
+    std::atomic<std::uint64_t> queueHighWater { 0u };
+
+    /** @brief Add a value to a counter (only called by the owning worker) */
+    static void Add(std::atomic<std::uint64_t> &counter, const std::uint64_t value = 1u) noexcept
+        { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+
+    /** @brief Raise a counter to a value if it is greater (only called by the owning worker) */
+    static void Max(std::atomic<std::uint64_t> &counter, const std::uint64_t value) noexcept
+        { if (value > counter.load(std::memory_order_relaxed)) counter.store(value, std::memory_order_relaxed); }
+
+    /** @brief Take a snapshot of the counters (any thread) */
+    [[nodiscard]] WorkerStats snapshot(void) const noexcept;
+};
+
+static_assert_fit_double_cacheline(kF::Flow::WorkerCounters);
+
+/** @brief Statistics of a scheduler */
+struct kF::Flow::SchedulerStats
+{
+    Core::Vector<WorkerStats> workers {}; // Stats of each worker
+    WorkerStats total {}; // Aggregated stats of all workers
+};
+
+inline std::uint64_t kF::Flow::WorkerStats::executedTaskCount(void) const noexcept
+{
+    std::uint64_t count { 0u };
+
+    for (const auto value : executedTasks)
+        count += value;
+    return count;
+}
+
+inline kF::Flow::WorkerStats &kF::Flow::WorkerStats::operator+=(const WorkerStats &other) noexcept
+{
+    for (auto i = 0ul; i < NodeTypeCount; ++i)
+        executedTasks[i] += other.executedTasks[i];
+    steals += other.steals;
+    failedSteals += other.failedSteals;
+    wakeUps += other.wakeUps;
+    idleNanoseconds += other.idleNanoseconds;
+    notificationRetries += other.notificationRetries;
+    queueHighWater = std::max(queueHighWater, other.queueHighWater);
+    return *this;
+}
+
+inline kF::Flow::WorkerStats kF::Flow::WorkerCounters::snapshot(void) const noexcept
+{
+    WorkerStats stats;
+
+    for (auto i = 0ul; i < NodeTypeCount; ++i)
+        stats.executedTasks[i] = executedTasks[i].load(std::memory_order_relaxed);
+    stats.steals = steals.load(std::memory_order_relaxed);
+    stats.failedSteals = failedSteals.load(std::memory_order_relaxed);
+    stats.wakeUps = wakeUps.load(std::memory_order_relaxed);
+    stats.idleNanoseconds = idleNanoseconds.load(std::memory_order_relaxed);
+    stats.notificationRetries = notificationRetries.load(std::memory_order_relaxed);
+    stats.queueHighWater = queueHighWater.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -55,9 +55,9 @@ public:
     /** @brief Retreive the type of the task */
     [[nodiscard]] NodeType type(void) const noexcept;
 
-    /** @brief Set the work event */
+    /** @brief Set the work event (throws if the graph is frozen) */
     template<typename Work>
-    void setWork(Work &&work) noexcept;
+    void setWork(Work &&work);
 
     /** @brief Check if the Task has a notification event */
     [[nodiscard]] bool hasNotification(void) const noexcept;
@@ -80,11 +80,23 @@ public:
     [[nodiscard]] bool bypass(void) const noexcept;
     void setBypass(const bool &bypass) noexcept;
 
-    /** @brief Add a task linked to this instance */
-    Task &precede(Task &task) noexcept;
+    /** @brief Get / Set the priority property, a ready task is always processed before lower priority ones */
+    [[nodiscard]] Priority priority(void) const noexcept;
+    void setPriority(const Priority priority) noexcept;
 
-    /** @brief Add a task linked from this instance */
-    Task &succeed(Task &task) noexcept { task.precede(*this); return *this; }
+    /** @brief Get / Set the relative cost of the task (default 1), used to rank tasks by their critical path */
+    [[nodiscard]] std::uint32_t cost(void) const noexcept;
+    void setCost(const std::uint32_t cost) noexcept;
+
+    /** @brief Get the rank of the task computed at last preprocessing: the cost of its longest path to a sink
+     *  Among ready tasks of the same priority, the highest ranked ones are processed first */
+    [[nodiscard]] std::uint32_t rank(void) const noexcept;
+
+    /** @brief Add a task linked to this instance (throws if a graph is frozen or if only one of the tasks is spawned) */
+    Task &precede(Task &task);
+
+    /** @brief Add a task linked from this instance (throws if a graph is frozen or if only one of the tasks is spawned) */
+    Task &succeed(Task &task) { task.precede(*this); return *this; }
 
 private:
     Node *_node { nullptr };
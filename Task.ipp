@@ -10,9 +10,13 @@ inline kF::Flow::NodeType kF::Flow::Task::type(void) const noexcept
 }
 
 template<typename Work>
-inline void kF::Flow::Task::setWork(Work &&work) noexcept
+inline void kF::Flow::Task::setWork(Work &&work)
 {
+    if (!_node->spawned && _node->root->frozen()) [[unlikely]]
+        throw std::logic_error("Flow::Task::setWork: Can't change the work of a node of a frozen graph");
+    ReportWorkStorage<Work, InlineWork<Work> ? WorkStorage::Inline : WorkStorage::Heap>();
     _node->workData = Node::ForwardWorkData(std::forward<Work>(work));
+    _node->root->invalidate(_node);
 }
 
 inline bool kF::Flow::Task::hasNotification(void) const noexcept
@@ -60,9 +64,42 @@ inline void kF::Flow::Task::setBypass(const bool &bypass) noexcept
     _node->bypass.store(bypass);
 }
 
-inline kF::Flow::Task &kF::Flow::Task::precede(Task &task) noexcept
+inline kF::Flow::Priority kF::Flow::Task::priority(void) const noexcept
 {
+    return _node->priority;
+}
+
+inline void kF::Flow::Task::setPriority(const Priority priority) noexcept
+{
+    _node->priority = priority;
+}
+
+inline std::uint32_t kF::Flow::Task::cost(void) const noexcept
+{
+    return _node->cost;
+}
+
+inline void kF::Flow::Task::setCost(const std::uint32_t cost) noexcept
+{
+    _node->cost = cost;
+    _node->root->invalidate(_node);
+}
+
+inline std::uint32_t kF::Flow::Task::rank(void) const noexcept
+{
+    return _node->rank;
+}
+
+inline kF::Flow::Task &kF::Flow::Task::precede(Task &task)
+{
+    // Packed edges and join counts of a frozen graph are only computed by 'freeze', spawned nodes are linked apart
+    if ((!_node->spawned && _node->root->frozen()) || (!task._node->spawned && task._node->root->frozen())) [[unlikely]]
+        throw std::logic_error("Flow::Task::precede: Can't link a node of a frozen graph");
+    // Join counts of spawned nodes are set when they are spawned, preprocessing doesn't know about them
+    if (_node->spawned != task._node->spawned) [[unlikely]]
+        throw std::logic_error("Flow::Task::precede: Can't link a spawned node to a node of the graph");
     _node->linkedTo.push(task._node);
     task._node->linkedFrom.push(_node);
+    _node->root->invalidate(_node);
     return *this;
 }
\ No newline at end of file
@@ -3,7 +3,13 @@ project(KubeFlowTests)
 get_filename_component(KubeFlowTestsDir ${CMAKE_CURRENT_LIST_FILE} PATH)
 
 set(KubeFlowTestsSources
+    ${KubeFlowTestsDir}/tests_Algorithms.cpp
+    ${KubeFlowTestsDir}/tests_Coroutine.cpp
+    ${KubeFlowTestsDir}/tests_GraphFuture.cpp
+    ${KubeFlowTestsDir}/tests_Pipeline.cpp
     ${KubeFlowTestsDir}/tests_Scheduler.cpp
+    ${KubeFlowTestsDir}/tests_Topology.cpp
+    ${KubeFlowTestsDir}/tests_WorkStealingDeque.cpp
 )
 
 add_executable(${CMAKE_PROJECT_NAME} ${KubeFlowTestsSources})
@@ -0,0 +1,116 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of parallel algorithms
+ */
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/Algorithms.hpp>
+
+using namespace kF;
+
+TEST(Algorithms, ParallelFor)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::vector<int> values(Count, 0);
+
+    Flow::Algorithms::parallelFor(graph, 0, Count, 2, [&values](const int i) { values[i] = i; });
+    scheduler.schedule(graph);
+    graph.wait();
+    for (auto i = 0; i < Count; ++i)
+        ASSERT_EQ(values[i], i % 2 ? 0 : i);
+}
+
+TEST(Algorithms, ChunkCount)
+{
+    // Outside of a worker, chunks are only split for the calling thread
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(0ul, 0ul), 1ul);
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(0ul, 1ul), 1ul);
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(3ul, 0ul), 3ul);
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(3ul, 1ul), 3ul);
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(100ul, 0ul), Flow::Algorithms::ChunksPerWorker);
+    ASSERT_EQ(Flow::Algorithms::ChunkCount(100ul, 50ul), 2ul);
+
+    // A null grain size is the same as a grain size of 1
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::vector<int> values(3, 0);
+    Flow::Algorithms::parallelFor(graph, 0, 3, 1, [&values](const int i) { values[i] = i + 1; }, 0ul);
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(values, std::vector<int>({ 1, 2, 3 }));
+}
+
+TEST(Algorithms, ParallelTransform)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::vector<int> input(Count);
+    std::vector<int> output(Count);
+
+    std::iota(input.begin(), input.end(), 0);
+    auto fill = graph.emplace([] {});
+    auto transform = Flow::Algorithms::parallelTransform(graph, input.begin(), input.end(), output.begin(), [](const int x) { return x * 2; });
+    fill.precede(transform);
+    scheduler.schedule(graph);
+    graph.wait();
+    for (auto i = 0; i < Count; ++i)
+        ASSERT_EQ(output[i], i * 2);
+}
+
+TEST(Algorithms, ParallelReduce)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::vector<std::size_t> values(Count);
+    std::size_t result = 0;
+
+    std::iota(values.begin(), values.end(), 1);
+    Flow::Algorithms::parallelReduce(graph, values.begin(), values.end(), result, std::plus<>());
+    for (auto i = 1; i <= 2; ++i) {
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(result, i * Count * (Count + 1ul) / 2);
+    }
+}
+
+TEST(Algorithms, ParallelSort)
+{
+    constexpr auto Count = 100000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::vector<int> values(Count);
+    std::mt19937 engine(42);
+
+    for (auto &value : values)
+        value = static_cast<int>(engine());
+    Flow::Algorithms::parallelSort(graph, values.begin(), values.end());
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(Algorithms, ParallelScan)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::vector<std::size_t> values(Count, 1);
+
+    Flow::Algorithms::parallelScan(graph, values.begin(), values.end(), values.begin());
+    scheduler.schedule(graph);
+    graph.wait();
+    for (auto i = 0ul; i < Count; ++i)
+        ASSERT_EQ(values[i], i + 1);
+}
@@ -0,0 +1,164 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of coroutine nodes
+ */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/Scheduler.hpp>
+
+using namespace kF;
+
+namespace
+{
+    /** @brief Awaitable completed by another thread, as an asynchronous I/O would be */
+    struct ThreadAwaitable
+    {
+        std::atomic<int> &trigger;
+
+        bool await_ready(void) const noexcept { return false; }
+        void await_suspend(const Flow::Coroutine::Handle handle) const
+        {
+            std::thread([handle, &trigger = trigger] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                ++trigger;
+                Flow::Coroutine::Reschedule(handle);
+            }).detach();
+        }
+        void await_resume(void) const noexcept {}
+    };
+}
+
+TEST(Coroutine, AwaitGraph)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, subgraph;
+    std::atomic<int> trigger = 0;
+
+    subgraph.emplace([&trigger] { trigger += 2; });
+    auto coroutine = graph.emplace([&trigger, &subgraph]() -> Flow::Coroutine {
+        ++trigger;
+        co_await subgraph;
+        trigger = trigger * 10;
+        co_await subgraph;
+    });
+    auto after = graph.emplace([&trigger] { ++trigger; });
+    ASSERT_EQ(coroutine.type(), Flow::NodeType::Coroutine);
+    coroutine.precede(after);
+
+    for (auto i = 0; i < 2; ++i) {
+        trigger = 0;
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(trigger, 33);
+    }
+}
+
+TEST(Coroutine, Spawn)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    graph.emplace([&trigger]() -> Flow::Coroutine {
+        for (auto i = 0; i < 10; ++i)
+            co_await Flow::Spawn([&trigger] { ++trigger; });
+        trigger = trigger * 2;
+    });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 20);
+}
+
+TEST(Coroutine, UserAwaitable)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0, order = 0;
+
+    graph.emplace([&trigger, &order]() -> Flow::Coroutine {
+        co_await ThreadAwaitable { trigger };
+        order = order * 10 + 1;
+    });
+    // The single worker is released while the coroutine waits, so this task runs in the meantime
+    graph.emplace([&order] { order = order * 10 + 2; });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 1);
+    ASSERT_EQ(order, 21);
+}
+
+TEST(Coroutine, Bypass)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    auto coroutine = graph.emplace([&trigger]() -> Flow::Coroutine {
+        ++trigger;
+        co_return;
+    });
+    auto after = graph.emplace([&trigger] { trigger += 2; });
+    coroutine.precede(after);
+    coroutine.setBypass(true);
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 2);
+}
+
+TEST(Coroutine, Exception)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, subgraph;
+    std::atomic<int> trigger = 0;
+
+    subgraph.emplace([] { throw std::runtime_error("Failure"); });
+    auto coroutine = graph.emplace([&trigger, &subgraph]() -> Flow::Coroutine {
+        try {
+            co_await subgraph;
+        } catch (const std::runtime_error &) {
+            ++trigger;
+        }
+        co_await subgraph;
+        ++trigger;
+    });
+    auto after = graph.emplace([&trigger] { ++trigger; });
+    coroutine.precede(after);
+
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::runtime_error);
+    ASSERT_EQ(trigger, 1);
+}
+
+TEST(Coroutine, AwaitRunningGraph)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, subgraph;
+    std::atomic<bool> released = false;
+    std::atomic<int> trigger = 0;
+
+    subgraph.emplace([&released] {
+        while (!released)
+            std::this_thread::yield();
+    });
+    graph.emplace([&trigger, &subgraph]() -> Flow::Coroutine {
+        ++trigger;
+        co_await subgraph;
+        trigger += 10;
+    });
+
+    // Awaiting a running graph fails the node, its suspended body is dropped
+    scheduler.schedule(subgraph);
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::logic_error);
+    ASSERT_EQ(trigger, 1);
+    released = true;
+    subgraph.wait();
+
+    // The next run starts the body again
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 12);
+}
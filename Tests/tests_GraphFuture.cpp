@@ -0,0 +1,111 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of graph futures
+ */
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/Scheduler.hpp>
+
+using namespace kF;
+
+TEST(GraphFuture, Wait)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    ASSERT_FALSE(Flow::GraphFuture().valid());
+    ASSERT_TRUE(Flow::GraphFuture().ready());
+    graph.emplace([&trigger] { ++trigger; });
+    auto future = scheduler.scheduleAsync(graph);
+    ASSERT_TRUE(future.valid());
+    future.wait();
+    ASSERT_TRUE(future.ready());
+    ASSERT_EQ(future.exception(), nullptr);
+    ASSERT_EQ(trigger, 1);
+
+    graph.emplace([] { throw std::runtime_error("Failure"); });
+    future = scheduler.scheduleAsync(graph);
+    ASSERT_TRUE(future.waitFor(std::chrono::seconds(10)));
+    ASSERT_NE(future.exception(), nullptr);
+    ASSERT_THROW(future.wait(), std::runtime_error);
+}
+
+TEST(GraphFuture, WaitFor)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<bool> release = false;
+
+    graph.emplace([&release] { while (!release) std::this_thread::yield(); });
+    auto future = scheduler.scheduleAsync(graph);
+    ASSERT_FALSE(future.waitFor(std::chrono::milliseconds(10)));
+    ASSERT_FALSE(future.ready());
+    release = true;
+    ASSERT_TRUE(future.waitFor(std::chrono::seconds(10)));
+}
+
+TEST(GraphFuture, Callbacks)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, empty;
+    std::atomic<int> trigger = 0;
+
+    graph.emplace([&trigger] { ++trigger; });
+    auto future = scheduler.scheduleAsync(graph, [&trigger] { trigger += 10; });
+    future.wait();
+    ASSERT_EQ(trigger, 11);
+
+    // Callbacks are called only once
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 12);
+
+    future = scheduler.scheduleAsync(graph, [&trigger] { trigger += 100; }, Flow::CompletionMode::Notification);
+    future.wait();
+    ASSERT_EQ(trigger, 13);
+    scheduler.processNotifications();
+    ASSERT_EQ(trigger, 113);
+
+    future = scheduler.scheduleAsync(empty, [&trigger] { trigger += 1000; });
+    ASSERT_TRUE(future.ready());
+    ASSERT_EQ(trigger, 1113);
+
+    // A failing worker callback fails the graph
+    future = scheduler.scheduleAsync(graph, [] { throw std::runtime_error("Failure"); });
+    ASSERT_THROW(future.wait(), std::runtime_error);
+}
+
+TEST(GraphFuture, WaitAnyAll)
+{
+    constexpr auto Count = 16;
+
+    Flow::Scheduler scheduler(2);
+    std::vector<Flow::Graph> graphs(Count);
+    std::vector<Flow::GraphFuture> futures;
+    std::atomic<bool> release = false;
+    std::atomic<int> trigger = 0;
+
+    for (auto i = 0; i < Count; ++i) {
+        if (i == Count / 2)
+            graphs[i].emplace([&trigger] { ++trigger; });
+        else
+            graphs[i].emplace([&release, &trigger] { while (!release) std::this_thread::yield(); ++trigger; });
+    }
+    ASSERT_EQ(scheduler.waitAny(futures), 0);
+    // The fast graph is scheduled first so that it doesn't wait for a worker blocked by the others
+    futures.resize(Count);
+    futures[Count / 2] = scheduler.scheduleAsync(graphs[Count / 2]);
+    for (auto i = 0; i < Count; ++i) {
+        if (i != Count / 2)
+            futures[i] = scheduler.scheduleAsync(graphs[i]);
+    }
+    ASSERT_EQ(scheduler.waitAny(futures), Count / 2);
+    ASSERT_FALSE(scheduler.waitAll(futures, std::chrono::milliseconds(10)));
+    release = true;
+    scheduler.waitAll(futures);
+    ASSERT_EQ(trigger, Count);
+    ASSERT_TRUE(scheduler.waitAll(futures, std::chrono::milliseconds(10)));
+    ASSERT_LT(scheduler.waitAny(futures, std::chrono::milliseconds(10)), Count);
+}
@@ -0,0 +1,167 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of the pipeline
+ */
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/Pipeline.hpp>
+
+using namespace kF;
+
+TEST(Pipeline, SerialStages)
+{
+    constexpr auto Count = 1000ul;
+    constexpr auto TokenCount = 4u;
+    Flow::Scheduler scheduler(4);
+    Flow::Pipeline pipeline(TokenCount);
+    std::array<std::size_t, TokenCount> values {};
+    std::size_t next = 0ul, sum = 0ul;
+    std::atomic<int> errors = 0;
+
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&values](Flow::PipelineToken &token) {
+        if (token.index() == Count)
+            return token.stop();
+        values[token.line()] = token.index();
+    });
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&values, &next, &errors](Flow::PipelineToken &token) {
+        errors += values[token.line()] != next++ || token.stage() != 1u;
+    });
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&values, &sum](Flow::PipelineToken &token) {
+        sum += values[token.line()];
+    });
+    ASSERT_EQ(pipeline.stageCount(), 3u);
+    ASSERT_EQ(pipeline.tokenCount(), TokenCount);
+    for (auto run = 0; run < 2; ++run) {
+        next = 0ul;
+        sum = 0ul;
+        scheduler.schedule(pipeline.graph());
+        pipeline.graph().wait();
+        ASSERT_EQ(pipeline.producedCount(), Count);
+        ASSERT_EQ(next, Count);
+        ASSERT_EQ(sum, Count * (Count - 1) / 2);
+        ASSERT_EQ(errors, 0);
+    }
+}
+
+TEST(Pipeline, ParallelStage)
+{
+    constexpr auto Count = 2000ul;
+    constexpr auto TokenCount = 8u;
+    Flow::Scheduler scheduler(4);
+    Flow::Pipeline pipeline(TokenCount);
+    std::array<std::size_t, TokenCount> values {};
+    std::atomic<std::uint32_t> inFlight = 0, maxInFlight = 0;
+    std::size_t next = 0ul, sum = 0ul;
+    int errors = 0;
+
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&](Flow::PipelineToken &token) {
+        if (token.index() == Count)
+            return token.stop();
+        values[token.line()] = token.index();
+        const auto count = ++inFlight;
+        for (auto max = maxInFlight.load(); count > max && !maxInFlight.compare_exchange_weak(max, count););
+    });
+    pipeline.addStage(Flow::StageType::Parallel, [&values](Flow::PipelineToken &token) {
+        values[token.line()] *= values[token.line()];
+    });
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&](Flow::PipelineToken &token) {
+        errors += values[token.line()] != next * next;
+        sum += values[token.line()];
+        ++next;
+        --inFlight;
+    });
+    scheduler.schedule(pipeline.graph());
+    pipeline.graph().wait();
+    ASSERT_EQ(next, Count);
+    ASSERT_EQ(sum, (Count - 1) * Count * (2 * Count - 1) / 6);
+    ASSERT_EQ(errors, 0);
+    ASSERT_LE(maxInFlight, TokenCount);
+}
+
+TEST(Pipeline, OutOfOrderStage)
+{
+    constexpr auto Count = 2000ul;
+    constexpr auto TokenCount = 8u;
+    Flow::Scheduler scheduler(4);
+    Flow::Pipeline pipeline(TokenCount);
+    std::array<std::size_t, TokenCount> values {};
+    std::atomic<bool> busy = false;
+    std::size_t sum = 0ul, count = 0ul;
+    std::atomic<int> errors = 0;
+
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&values](Flow::PipelineToken &token) {
+        if (token.index() == Count)
+            return token.stop();
+        values[token.line()] = token.index();
+    });
+    pipeline.addStage(Flow::StageType::Parallel, [&values](Flow::PipelineToken &token) {
+        values[token.line()] += 1ul;
+    });
+    // Tokens may reach this stage in any order, but never at the same time
+    pipeline.addStage(Flow::StageType::SerialOutOfOrder, [&](Flow::PipelineToken &token) {
+        errors += busy.exchange(true);
+        sum += values[token.line()];
+        ++count;
+        busy = false;
+    });
+    scheduler.schedule(pipeline.graph());
+    pipeline.graph().wait();
+    ASSERT_EQ(count, Count);
+    ASSERT_EQ(sum, Count * (Count + 1) / 2);
+    ASSERT_EQ(errors, 0);
+}
+
+TEST(Pipeline, NestedPipeline)
+{
+    constexpr auto Count = 100ul;
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    Flow::Pipeline pipeline(1);
+    std::size_t produced = 0ul, processed = 0ul;
+
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&produced](Flow::PipelineToken &token) {
+        if (token.index() == Count)
+            return token.stop();
+        ++produced;
+    });
+    pipeline.addStage(Flow::StageType::SerialInOrder, [&processed](Flow::PipelineToken &) { ++processed; });
+    auto before = graph.emplace([&produced] { produced = 0ul; });
+    auto stream = graph.emplace(pipeline.graph());
+    auto after = graph.emplace([&processed] { processed *= 2ul; });
+    before.precede(stream);
+    stream.precede(after);
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(produced, Count);
+    ASSERT_EQ(processed, 2 * Count);
+}
+
+TEST(Pipeline, Errors)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Pipeline empty(2), pipeline(2);
+    bool fail = true;
+
+    ASSERT_THROW(Flow::Pipeline(0), std::logic_error);
+    ASSERT_THROW(empty.addStage(Flow::StageType::Parallel, [](Flow::PipelineToken &) {}), std::logic_error);
+    scheduler.schedule(empty.graph());
+    ASSERT_THROW(empty.graph().wait(), std::logic_error);
+
+    // Only the first stage can stop the stream, the exception stops it and the pipeline can run again
+    pipeline.addStage(Flow::StageType::SerialInOrder, [](Flow::PipelineToken &token) {
+        if (token.index() == 10u)
+            token.stop();
+    });
+    pipeline.addStage(Flow::StageType::SerialOutOfOrder, [&fail](Flow::PipelineToken &token) {
+        if (fail)
+            token.stop();
+    });
+    scheduler.schedule(pipeline.graph());
+    ASSERT_THROW(pipeline.graph().wait(), std::logic_error);
+    ASSERT_LE(pipeline.producedCount(), pipeline.tokenCount());
+    fail = false;
+    scheduler.schedule(pipeline.graph());
+    pipeline.graph().wait();
+    ASSERT_EQ(pipeline.producedCount(), 10u);
+}
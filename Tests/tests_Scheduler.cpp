@@ -3,6 +3,16 @@
  * @ Description: Unit tests of Scheduler
  */
 
+#include <array>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+# include <poll.h>
+#endif
+
 #include <gtest/gtest.h>
 
 #include <Kube/Flow/Scheduler.hpp>
@@ -221,6 +231,23 @@ TEST(Scheduler, DynamicTask)
     ASSERT_EQ(trigger, 4);
 }
 
+TEST(Scheduler, EmptyGraph)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph empty, graph;
+    std::atomic<int> trigger = 0;
+
+    scheduler.schedule(empty);
+    empty.wait();
+    graph.emplace([&trigger](Flow::Graph &sub) {
+        sub.clear();
+        ++trigger;
+    });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 1);
+}
+
 TEST(Scheduler, RepeatBasics)
 {
     Flow::Scheduler scheduler(1);
@@ -234,4 +261,941 @@ TEST(Scheduler, RepeatBasics)
     scheduler.schedule(graph);
     graph.wait();
     ASSERT_EQ(trigger, 3);
-}
\ No newline at end of file
+}
+
+TEST(Scheduler, FanOutFanIn)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    auto begin = graph.emplace([&trigger] { ++trigger; });
+    auto end = graph.emplace([&trigger] { ++trigger; });
+    for (auto i = 0; i < Count; ++i) {
+        auto task = graph.emplace([&trigger] { ++trigger; });
+        begin.precede(task);
+        task.precede(end);
+    }
+    for (auto i = 1; i <= 3; ++i) {
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(trigger, i * (Count + 2));
+    }
+}
+
+TEST(Scheduler, DynamicTaskSuccessor)
+{
+    Flow::Scheduler scheduler;
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    auto a = graph.emplace([&trigger](Flow::Graph &sub) {
+        sub.clear();
+        sub.emplace([&trigger] { ++trigger; });
+    });
+    auto b = graph.emplace([&trigger] { trigger = trigger * 10; });
+    a.precede(b);
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 10);
+}
+
+TEST(Scheduler, LongSequenceTask)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    int trigger = 0;
+
+    auto last = graph.emplace([&trigger] { ASSERT_EQ(trigger, 0); ++trigger; });
+    for (auto i = 1; i < Count; ++i) {
+        auto task = graph.emplace([&trigger, i] { ASSERT_EQ(trigger, i); ++trigger; });
+        last.precede(task);
+        last = task;
+    }
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, Count);
+}
+
+TEST(Scheduler, FrozenGraph)
+{
+    Flow::Scheduler scheduler;
+    std::atomic<int> trigger = 0;
+    Flow::Graph graph;
+
+    auto a = graph.emplace([&trigger]() -> bool { return trigger != 0; });
+    auto b = graph.emplace([&trigger] { trigger = 1; });
+    auto c = graph.emplace([&trigger] { trigger = 2; });
+    auto d = graph.emplace([&trigger] { trigger = 3; });
+    auto e = graph.emplace([&trigger] { trigger = 4; });
+    auto f = graph.emplace([&trigger] { trigger = 5; });
+    b.succeed(a); // 0 returned
+    c.succeed(a); // 1 returned
+    d.succeed(c);
+    e.succeed(c);
+    f.succeed(d);
+    f.succeed(e);
+
+    graph.freeze();
+    ASSERT_TRUE(graph.frozen());
+    ASSERT_EQ(graph.size(), 6);
+    ASSERT_ANY_THROW(graph.emplace([] {}));
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 1);
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 5);
+
+    graph.clear();
+    ASSERT_FALSE(graph.frozen());
+    graph.emplace([&trigger] { trigger = 6; });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 6);
+}
+
+TEST(Scheduler, FrozenGraphLinks)
+{
+    Flow::Scheduler scheduler;
+    std::atomic<int> trigger = 0;
+    Flow::Graph graph, other;
+
+    auto a = graph.emplace([&trigger] { ++trigger; });
+    auto b = graph.emplace([&trigger] { ++trigger; });
+    auto c = other.emplace([] {});
+    a.precede(b);
+    graph.freeze();
+
+    // Tasks are packed by 'freeze', the frozen topology can't be modified anymore
+    Flow::Task first(graph.begin()->node()), second((graph.begin() + 1)->node());
+    ASSERT_ANY_THROW(second.precede(first));
+    ASSERT_ANY_THROW(first.succeed(second));
+    ASSERT_ANY_THROW(c.precede(first));
+    ASSERT_ANY_THROW(first.setWork([&trigger] { trigger = -1; }));
+    ASSERT_ANY_THROW(graph.clearLinks());
+    for (auto i = 1; i <= 3; ++i) {
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(trigger, i * 2);
+    }
+
+    // Once cleared, the graph can be linked again
+    graph.clear();
+    a = graph.emplace([&trigger] { trigger = 1; });
+    b = graph.emplace([&trigger] { trigger = trigger * 10; });
+    b.precede(a);
+    graph.freeze();
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 1);
+}
+
+TEST(Scheduler, SwitchTaskIncremental)
+{
+    Flow::Scheduler scheduler;
+    std::atomic<int> trigger = 0;
+    Flow::Graph graph;
+
+    auto a = graph.emplace([&trigger]() -> bool { return trigger != 0; });
+    auto b = graph.emplace([&trigger] { trigger = 1; });
+    auto c = graph.emplace([&trigger] { trigger = 2; });
+    b.succeed(a); // 0 returned
+    c.succeed(a); // 1 returned
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 1);
+
+    // Extend the first branch after the graph was preprocessed
+    auto d = graph.emplace([&trigger] { trigger = 3; });
+    auto e = graph.emplace([&trigger] { trigger = 4; });
+    d.succeed(b);
+    e.succeed(d);
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 2);
+
+    trigger = 0;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 4);
+}
+
+TEST(Scheduler, Tracing)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+
+    // The two bytes of 'é' don't fit in the event, neither is kept
+    const auto longName = std::string(Flow::TraceEvent::MaxNameSize - 1, 'x') + "\xC3\xA9";
+    auto a = graph.emplace([] {}, "A \"quoted\" name");
+    auto b = graph.emplace([] {}, longName);
+    a.precede(b);
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(scheduler.tracer(), nullptr);
+
+    scheduler.enableTracing();
+    scheduler.schedule(graph);
+    graph.wait();
+    scheduler.disableTracing();
+    scheduler.schedule(graph);
+    graph.wait();
+
+    std::stringstream stream;
+    scheduler.tracer()->exportChromeTrace(stream);
+    const auto trace = stream.str();
+    ASSERT_EQ(trace.find("{\"traceEvents\":["), 0);
+    ASSERT_NE(trace.find("A \\\"quoted\\\" name"), std::string::npos);
+    ASSERT_EQ(trace.find("A \\\"quoted\\\" name"), trace.rfind("A \\\"quoted\\\" name"));
+    ASSERT_NE(trace.find("\"" + longName.substr(0, Flow::TraceEvent::MaxNameSize - 1) + "\""), std::string::npos);
+}
+
+TEST(Scheduler, Stats)
+{
+    constexpr auto Count = 64u;
+
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, subgraph;
+    std::atomic<std::size_t> trigger { 0u };
+
+    subgraph.emplace([] {});
+    auto root = graph.emplace([] {}, [&trigger] { ++trigger; });
+    auto sub = graph.emplace(subgraph);
+    auto branch = graph.emplace([] { return 0ul; });
+    auto end = graph.emplace([] {});
+    root.precede(sub);
+    sub.precede(branch);
+    branch.precede(end);
+    for (auto i = 0u; i < Count; ++i) {
+        auto task = graph.emplace([] {});
+        root.precede(task);
+    }
+
+    scheduler.schedule(graph);
+    graph.wait();
+    while (!trigger)
+        scheduler.processNotifications();
+
+    const auto stats = scheduler.stats();
+    ASSERT_EQ(stats.workers.size(), 2);
+    ASSERT_EQ(stats.total.executedTasks[static_cast<std::size_t>(Flow::NodeType::Static)], Count + 3);
+    ASSERT_EQ(stats.total.executedTasks[static_cast<std::size_t>(Flow::NodeType::Switch)], 1);
+    ASSERT_EQ(stats.total.executedTasks[static_cast<std::size_t>(Flow::NodeType::Graph)], 1);
+    ASSERT_EQ(stats.total.executedTaskCount(), Count + 5);
+    ASSERT_GE(stats.total.queueHighWater, 1);
+    std::uint64_t steals = 0u;
+    for (const auto &worker : stats.workers)
+        steals += worker.steals;
+    ASSERT_EQ(stats.total.steals, steals);
+}
+
+TEST(Scheduler, Priorities)
+{
+    constexpr auto Count = 32u;
+
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::atomic<std::size_t> executed = 0, lastHigh = 0, firstLow = Count * 3;
+
+    auto root = graph.emplace([] {});
+    for (auto i = 0u; i < Count; ++i) {
+        auto low = graph.emplace([&executed, &firstLow] {
+            const auto index = executed++;
+            if (index < firstLow)
+                firstLow = index;
+        });
+        auto normal = graph.emplace([&executed] { ++executed; });
+        auto high = graph.emplace([&executed, &lastHigh] { lastHigh = executed++; });
+        low.setPriority(Flow::Priority::Low);
+        high.setPriority(Flow::Priority::High);
+        ASSERT_EQ(normal.priority(), Flow::Priority::Normal);
+        root.precede(low);
+        root.precede(normal);
+        root.precede(high);
+    }
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(executed, Count * 3);
+    ASSERT_EQ(lastHigh, Count - 1);
+    ASSERT_EQ(firstLow, Count * 2);
+}
+
+TEST(Scheduler, CriticalPathRanks)
+{
+    constexpr auto Length = 5u;
+
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::vector<int> order;
+
+    auto root = graph.emplace([] {});
+    for (auto i = 0u; i < Length; ++i) {
+        auto task = graph.emplace([&order] { order.push_back(0); });
+        root.precede(task);
+    }
+    auto last = graph.emplace([&order] { order.push_back(1); });
+    root.precede(last);
+    for (auto i = 1u; i < Length; ++i) {
+        auto task = graph.emplace([&order] { order.push_back(2); });
+        last.precede(task);
+        last = task;
+    }
+    last.setCost(10);
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(root.rank(), Length + 10);
+    ASSERT_EQ(order.size(), Length * 2);
+    // The head of the long chain is processed first, short tasks only fill the gaps
+    ASSERT_EQ(order.front(), 1);
+}
+
+TEST(Scheduler, CriticalPathRoots)
+{
+    constexpr auto Length = 5u;
+
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::vector<int> order;
+
+    for (auto i = 0u; i < Length; ++i)
+        graph.emplace([&order] { order.push_back(0); });
+    auto last = graph.emplace([&order] { order.push_back(1); });
+    for (auto i = 1u; i < Length; ++i) {
+        auto task = graph.emplace([&order] { order.push_back(2); });
+        last.precede(task);
+        last = task;
+    }
+
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(order.size(), Length * 2);
+    // The root of the long chain is scheduled first even though it was emplaced last
+    ASSERT_EQ(order.front(), 1);
+}
+
+TEST(Scheduler, MeasuredCosts)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+
+    auto slow = graph.emplace([] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+    auto fast = graph.emplace([] {});
+    graph.setCostMeasurement(true);
+    for (auto i = 0; i < 4; ++i) {
+        scheduler.schedule(graph);
+        graph.wait();
+    }
+    ASSERT_GT(slow.cost(), fast.cost());
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_GT(slow.rank(), fast.rank());
+}
+
+TEST(Scheduler, IdlePolicy)
+{
+    constexpr auto Count = 256u;
+
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::atomic<std::size_t> trigger = 0;
+
+    auto root = graph.emplace([] {});
+    for (auto i = 0u; i < Count; ++i) {
+        auto task = graph.emplace([&trigger] { ++trigger; });
+        root.precede(task);
+    }
+    for (const auto spinCount : { 0u, 1u, 64u }) {
+        scheduler.setIdlePolicy(Flow::IdlePolicy { spinCount: spinCount });
+        ASSERT_EQ(scheduler.idlePolicy().spinCount, spinCount);
+        for (auto i = 0; i < 8; ++i) {
+            scheduler.schedule(graph);
+            graph.wait();
+        }
+    }
+    ASSERT_EQ(trigger, Count * 8 * 3);
+}
+
+TEST(Scheduler, DeeplyNestedGraphs)
+{
+    constexpr auto Depth = 2000u;
+
+    Flow::Scheduler scheduler(2);
+    std::vector<Flow::Graph> graphs(Depth);
+    std::atomic<int> trigger = 0;
+
+    graphs.back().emplace([&trigger] { ++trigger; });
+    for (auto i = Depth - 1; i; --i) {
+        auto before = graphs[i - 1].emplace([&trigger] { ++trigger; });
+        auto nested = graphs[i - 1].emplace(graphs[i], [&trigger] { trigger += 2; });
+        before.precede(nested);
+    }
+    scheduler.schedule(graphs.front());
+    graphs.front().wait();
+    ASSERT_EQ(trigger, Depth);
+    for (const auto &graph : graphs)
+        ASSERT_FALSE(graph.running());
+    scheduler.processNotifications();
+    ASSERT_EQ(trigger, Depth + (Depth - 1) * 2);
+}
+
+TEST(Scheduler, CachedRoots)
+{
+    constexpr auto Count = 10000;
+
+    Flow::Scheduler scheduler(4, 1024);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    // More roots than the shared queue can hold
+    for (auto i = 0; i < Count; ++i)
+        graph.emplace([&trigger] { ++trigger; });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, Count);
+    ASSERT_EQ(graph.roots().size(), Count);
+
+    // A new node is a new root
+    auto last = graph.emplace([&trigger] { ++trigger; });
+    ASSERT_EQ(graph.roots().size(), Count + 1);
+    trigger = 0;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, Count + 1);
+
+    // Linked nodes aren't roots anymore
+    Flow::Task first(graph.begin()->node());
+    first.precede(last);
+    trigger = 0;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, Count + 1);
+    ASSERT_EQ(graph.roots().size(), Count);
+
+    // Roots follow the nodes of a frozen graph
+    graph.freeze();
+    trigger = 0;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, Count + 1);
+    for (const auto root : graph.roots())
+        ASSERT_TRUE(root.node()->linkedFrom.empty());
+}
+
+TEST(Scheduler, BulkSchedule)
+{
+    constexpr auto Count = 5000;
+
+    Flow::Scheduler scheduler(4, 1024);
+    Flow::Graph graph;
+    std::vector<Flow::Task> tasks;
+    std::atomic<int> trigger = 0;
+
+    for (auto i = 0; i < Count; ++i) {
+        auto task = graph.emplace([&trigger] { ++trigger; });
+        task.setPriority(i % 2 ? Flow::Priority::High : Flow::Priority::Normal);
+        tasks.push_back(task);
+    }
+    scheduler.schedule(std::span<const Flow::Task>(tasks).first(Count / 2));
+    // From a worker, tasks go to its local queues
+    Flow::Graph spawner;
+    spawner.emplace([&scheduler, &tasks] { scheduler.schedule(std::span<const Flow::Task>(tasks).subspan(Count / 2)); });
+    scheduler.schedule(spawner);
+    spawner.wait();
+    while (trigger != Count)
+        std::this_thread::yield();
+    // Batches pushed into local queues count toward their high water mark
+    ASSERT_GE(scheduler.stats().total.queueHighWater, 1);
+}
+
+TEST(Scheduler, InjectedTasks)
+{
+    constexpr auto Count = 1000;
+
+    Flow::Scheduler scheduler(2, 16);
+    Flow::Graph blocker;
+    Flow::Graph graph;
+    std::vector<Flow::Task> tasks;
+    std::atomic<bool> released = false;
+    std::atomic<int> trigger = 0;
+
+    // Busy workers can't drain the shared queue, other threads inject the overflow instead of waiting
+    for (auto i = 0ul; i < scheduler.workerCount(); ++i) {
+        blocker.emplace([&released] {
+            while (!released)
+                std::this_thread::yield();
+        });
+    }
+    for (auto i = 0; i < Count; ++i)
+        tasks.push_back(graph.emplace([&trigger] { ++trigger; }));
+    scheduler.schedule(blocker);
+    scheduler.schedule(std::span<const Flow::Task>(tasks));
+    ASSERT_EQ(trigger, 0);
+    released = true;
+    blocker.wait();
+    while (trigger != Count)
+        std::this_thread::yield();
+}
+
+TEST(Scheduler, DirectTasks)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    // Tasks scheduled on their own don't count toward the completion of a later run of their graph
+    auto first = graph.emplace([&trigger] { ++trigger; });
+    graph.emplace([&trigger] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ++trigger;
+    });
+    scheduler.schedule(first);
+    while (trigger != 1)
+        std::this_thread::yield();
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 3);
+}
+
+TEST(Scheduler, Exception)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<bool> fail = true;
+    std::atomic<int> trigger = 0;
+
+    auto first = graph.emplace([&fail] { if (fail) throw std::runtime_error("Failure"); });
+    auto second = graph.emplace([&trigger] { ++trigger; });
+    auto third = graph.emplace([&trigger] { ++trigger; });
+    first.precede(second);
+    second.precede(third);
+
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::runtime_error);
+    ASSERT_TRUE(graph.cancelled());
+    ASSERT_FALSE(graph.running());
+    ASSERT_EQ(trigger, 0);
+
+    // The next run starts clean
+    fail = false;
+    scheduler.schedule(graph);
+    ASSERT_NO_THROW(graph.wait());
+    ASSERT_FALSE(graph.cancelled());
+    ASSERT_EQ(trigger, 2);
+}
+
+TEST(Scheduler, NestedException)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, subgraph;
+    std::atomic<int> trigger = 0;
+
+    subgraph.emplace([] { throw std::runtime_error("Failure"); });
+    auto nested = graph.emplace(subgraph);
+    auto after = graph.emplace([&trigger] { ++trigger; });
+    nested.precede(after);
+    auto dynamic = graph.emplace([](Flow::Graph &graph) {
+        graph.emplace([] { throw std::logic_error("Failure"); });
+    });
+    auto afterDynamic = graph.emplace([&trigger] { ++trigger; });
+    dynamic.precede(afterDynamic);
+
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::exception);
+    ASSERT_EQ(trigger, 0);
+}
+
+TEST(Scheduler, Cancel)
+{
+    constexpr auto Count = 1000;
+
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    auto last = graph.emplace([&graph] { graph.cancel(); });
+    auto branch = graph.emplace([] { return 1ul; });
+    last.precede(branch);
+    auto left = graph.emplace([&trigger] { ++trigger; });
+    auto right = graph.emplace([&trigger] { ++trigger; });
+    branch.precede(left);
+    branch.precede(right);
+    for (auto i = 0; i < Count; ++i) {
+        auto task = graph.emplace([&trigger] { ++trigger; });
+        last.precede(task);
+        last = task;
+    }
+    scheduler.schedule(graph);
+    ASSERT_NO_THROW(graph.wait());
+    ASSERT_TRUE(graph.cancelled());
+    ASSERT_EQ(trigger, 0);
+}
+
+TEST(Scheduler, RepeatException)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    graph.emplace([&trigger] { ++trigger; });
+    graph.setRepeatCallback([&trigger]() -> bool {
+        if (trigger == 3)
+            throw std::runtime_error("Failure");
+        return true;
+    });
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::runtime_error);
+    ASSERT_EQ(trigger, 3);
+}
+
+TEST(Scheduler, NotificationBatches)
+{
+    constexpr auto Count = 100;
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    int trigger = 0;
+
+    for (auto i = 0; i < Count; ++i)
+        graph.emplace([] {}, [&trigger] { ++trigger; });
+    ASSERT_FALSE(scheduler.hasPendingNotifications());
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_TRUE(scheduler.hasPendingNotifications());
+    ASSERT_EQ(scheduler.processNotifications(30), 30);
+    ASSERT_EQ(trigger, 30);
+    ASSERT_TRUE(scheduler.waitNotifications(std::chrono::milliseconds(0)));
+    ASSERT_EQ(scheduler.processNotifications(), Count - 30);
+    ASSERT_EQ(trigger, Count);
+    ASSERT_FALSE(scheduler.hasPendingNotifications());
+    ASSERT_EQ(scheduler.processNotifications(), 0);
+}
+
+TEST(Scheduler, NotificationOrder)
+{
+    constexpr auto Count = 256;
+    Flow::Scheduler scheduler(1, Flow::Scheduler::DefaultTaskQueueSize, 4);
+    Flow::Graph graph;
+    std::vector<int> order;
+
+    // The lane of the worker overflows many times, its notifications must still come in order
+    auto last = graph.emplace([] {}, [&order] { order.push_back(0); });
+    for (auto i = 1; i < Count; ++i) {
+        auto task = graph.emplace([] {}, [&order, i] { order.push_back(i); });
+        last.precede(task);
+        last = task;
+    }
+    scheduler.schedule(graph);
+    while (order.size() != Count) {
+        scheduler.processNotifications(3);
+        std::this_thread::yield();
+    }
+    graph.wait();
+    for (auto i = 0; i < Count; ++i)
+        ASSERT_EQ(order[i], i);
+}
+
+TEST(Scheduler, WaitNotifications)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    std::atomic<bool> release = false;
+    int trigger = 0;
+
+    graph.emplace([&release] { while (!release) std::this_thread::yield(); }, [&trigger] { ++trigger; });
+    ASSERT_FALSE(scheduler.waitNotifications(std::chrono::milliseconds(5)));
+    scheduler.schedule(graph);
+    ASSERT_FALSE(scheduler.waitNotifications(std::chrono::milliseconds(5)));
+    release = true;
+    ASSERT_TRUE(scheduler.waitNotifications());
+    ASSERT_EQ(scheduler.processNotifications(), 1);
+    ASSERT_EQ(trigger, 1);
+    graph.wait();
+}
+
+#if defined(__linux__)
+TEST(Scheduler, NotificationFd)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph;
+    pollfd descriptor { fd: scheduler.notificationFd(), events: POLLIN, revents: 0 };
+
+    ASSERT_GE(descriptor.fd, 0);
+    ASSERT_EQ(::poll(&descriptor, 1, 0), 0);
+    graph.emplace([] {}, [] {});
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(::poll(&descriptor, 1, 1000), 1);
+    ASSERT_EQ(scheduler.processNotifications(), 1);
+    ASSERT_EQ(::poll(&descriptor, 1, 0), 0);
+}
+#endif
+
+TEST(Scheduler, SpawnFibonacci)
+{
+    constexpr std::size_t N = 16;
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::function<void(const std::size_t, std::size_t &)> fibonacci;
+    std::size_t result = 0, observed = 0;
+
+    // Each call spawns its sub-problems and a sum node holding the successors of the call until the whole expansion is done
+    fibonacci = [&graph, &fibonacci](const std::size_t n, std::size_t &value) {
+        if (n < 2) {
+            value = n;
+            return;
+        }
+        auto values = std::make_shared<std::array<std::size_t, 2>>();
+        auto left = graph.spawn([&fibonacci, n, values] { fibonacci(n - 1, (*values)[0]); });
+        auto right = graph.spawn([&fibonacci, n, values] { fibonacci(n - 2, (*values)[1]); });
+        auto sum = graph.spawn([values, &value] { value = (*values)[0] + (*values)[1]; });
+        left.precede(sum);
+        right.precede(sum);
+        graph.deferSuccessors(sum);
+    };
+    auto root = graph.emplace([&fibonacci, &result] { fibonacci(N, result); });
+    auto check = graph.emplace([&result, &observed] { observed = result; });
+    root.precede(check);
+    for (auto i = 0; i < 3; ++i) {
+        if (i == 2)
+            graph.freeze();
+        result = 0;
+        observed = 0;
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(observed, 987);
+        ASSERT_EQ(graph.size(), 2);
+    }
+}
+
+TEST(Scheduler, SpawnRepeat)
+{
+    constexpr auto Count = 100;
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+    int runs = 0;
+
+    graph.emplace([&graph, &trigger] {
+        for (auto i = 0; i < Count; ++i)
+            graph.spawn([&trigger] { ++trigger; });
+    });
+    graph.setRepeatCallback([&runs] { return ++runs != 4; });
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 4 * Count);
+}
+
+TEST(Scheduler, SpawnErrors)
+{
+    Flow::Scheduler scheduler(1);
+    Flow::Graph graph, other;
+
+    other.emplace([] {});
+    ASSERT_THROW(graph.spawn([] {}), std::logic_error);
+    graph.emplace([&other] { other.spawn([] {}); });
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::logic_error);
+    graph.clear();
+    graph.emplace([&graph] { graph.spawn([] { return 0ul; }); });
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::logic_error);
+    graph.clear();
+    auto regular = graph.emplace([] {});
+    graph.emplace([&graph, &regular] { graph.spawn([] {}).precede(regular); });
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::logic_error);
+}
+
+TEST(Scheduler, WideGraph)
+{
+    constexpr auto Count = 20000;
+    Flow::Scheduler scheduler(2, 16);
+    Flow::Graph graph;
+    std::atomic<int> trigger = 0;
+
+    // Far more ready tasks than any queue can hold at first, from a worker and from the caller
+    auto root = graph.emplace([] {});
+    for (auto i = 0; i < Count; ++i) {
+        auto task = graph.emplace([&trigger] { ++trigger; });
+        root.precede(task);
+        graph.emplace([&trigger] { ++trigger; });
+    }
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(trigger, 2 * Count);
+}
+
+TEST(Scheduler, WorkStorage)
+{
+    constexpr auto Count = 1000;
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph;
+    std::atomic<std::size_t> sum = 0;
+    auto owner = std::make_shared<int>(0);
+    std::array<std::size_t, 4> values { 1, 2, 3, 4 };
+
+    auto small = [&sum] { ++sum; };
+    auto large = [&sum, values] { sum += values[0] + values[1] + values[2] + values[3]; };
+    auto owning = [&sum, owner] { sum += static_cast<std::size_t>(*owner); };
+    auto huge = [&sum, buffer = std::array<char, 2048> {}] { sum += static_cast<std::size_t>(buffer[0]); };
+    static_assert(Flow::EmplacedWorkStorage<decltype(small)> == Flow::WorkStorage::Inline);
+    static_assert(Flow::EmplacedWorkStorage<decltype(large)> == Flow::WorkStorage::Arena);
+    static_assert(Flow::EmplacedWorkStorage<decltype(owning)> == Flow::WorkStorage::Arena);
+    static_assert(Flow::EmplacedWorkStorage<decltype(huge)> == Flow::WorkStorage::Heap);
+    static_assert(Flow::EmplacedWorkStorage<Flow::StaticFunc> == Flow::WorkStorage::Inline);
+
+    // Arena works keep their node type and are destroyed with the graph children
+    auto branch = graph.emplace([&sum, values]() -> std::size_t { return values[0] + (sum > 1'000'000'000); });
+    auto skipped = graph.emplace(large);
+    auto taken = graph.emplace(small);
+    branch.precede(skipped);
+    branch.precede(taken);
+    graph.emplace([&sum, values](Flow::Graph &sub) {
+        sub.clear();
+        sub.emplace([&sum, values] { sum += values[3]; });
+    });
+    for (auto i = 0; i < Count; ++i) {
+        graph.emplace(large);
+        graph.emplace(owning);
+    }
+    ASSERT_EQ(owner.use_count(), Count + 2);
+    *owner = 1;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(sum, 1 + 4 + Count * (10 + 1));
+    graph.clear();
+    ASSERT_EQ(owner.use_count(), 2);
+}
+
+TEST(Scheduler, PipelinedRepeat)
+{
+    constexpr auto Count = 1000;
+    constexpr auto Width = 4;
+    Flow::Scheduler scheduler(4);
+    Flow::Graph graph;
+    std::atomic<int> first = 0, last = 0, errors = 0;
+    std::array<std::atomic<int>, Width> middle {};
+    int runs = 0;
+
+    // A node runs iteration 'k' after its predecessors ran it, and at most one iteration ahead of its successors
+    auto source = graph.emplace([&first] { ++first; });
+    auto sink = graph.emplace([&last, &middle, &errors] {
+        for (auto &count : middle)
+            errors += count <= last;
+        ++last;
+    });
+    for (auto &count : middle) {
+        auto task = graph.emplace([&first, &last, &count, &errors] {
+            errors += first <= count || first > count + 2 || count > last + 1;
+            ++count;
+        });
+        source.precede(task);
+        task.precede(sink);
+    }
+    graph.freeze();
+    graph.setRepeatMode(Flow::RepeatMode::Pipelined);
+    graph.setRepeatCallback([&runs] { return ++runs != Count; });
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.setRepeatMode(Flow::RepeatMode::Sequential), std::logic_error);
+    graph.wait();
+    ASSERT_EQ(first, Count);
+    ASSERT_EQ(last, Count);
+    for (auto &count : middle)
+        ASSERT_EQ(count, Count);
+    ASSERT_EQ(errors, 0);
+
+    // Counters are reset on each schedule, a sequential run still works on the same graph
+    runs = Count - 3;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(last, Count + 3);
+    graph.setRepeatMode(Flow::RepeatMode::Sequential);
+    runs = Count - 3;
+    scheduler.schedule(graph);
+    graph.wait();
+    ASSERT_EQ(last, Count + 6);
+    ASSERT_EQ(errors, 0);
+}
+
+TEST(Scheduler, PipelinedErrors)
+{
+    Flow::Scheduler scheduler(2);
+    Flow::Graph graph, parent;
+    std::atomic<int> trigger = 0;
+
+    graph.emplace([&trigger] { ++trigger; });
+    graph.setRepeatMode(Flow::RepeatMode::Pipelined);
+    ASSERT_THROW(scheduler.schedule(graph), std::logic_error);
+    ASSERT_FALSE(graph.running());
+    graph.emplace([](Flow::Graph &) {});
+    graph.freeze();
+    ASSERT_THROW(scheduler.schedule(graph), std::logic_error);
+    graph.clear();
+    graph.emplace([&graph] { graph.spawn([] {}); });
+    graph.freeze();
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::logic_error);
+    parent.emplace(graph);
+    scheduler.schedule(parent);
+    ASSERT_THROW(parent.wait(), std::logic_error);
+
+    // An exception stops planning new iterations, those already planned are skipped
+    graph.clear();
+    graph.emplace([&trigger] {
+        if (++trigger == 3)
+            throw std::runtime_error("Failure");
+    });
+    graph.freeze();
+    graph.setRepeatCallback([] { return true; });
+    trigger = 0;
+    scheduler.schedule(graph);
+    ASSERT_THROW(graph.wait(), std::runtime_error);
+    ASSERT_EQ(trigger, 3);
+}
+
+TEST(Scheduler, HeldJoins)
+{
+    constexpr auto GraphCount = 64;
+    constexpr auto Count = 100;
+    Flow::Scheduler scheduler(1);
+    Flow::Graph first, second;
+    std::atomic<bool> completed = false;
+    std::atomic<int> trigger = 0;
+
+    // The only worker runs the long node of 'second' right after the last node of 'first', which must complete meanwhile
+    second.emplace([&completed] {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!completed && std::chrono::steady_clock::now() < end)
+            std::this_thread::yield();
+    });
+    first.emplace([&scheduler, &second] { scheduler.schedule(second); });
+    const auto begin = std::chrono::steady_clock::now();
+    scheduler.schedule(first);
+    first.wait();
+    completed = true;
+    second.wait();
+    ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(4));
+
+    // Interleaved graphs complete once every one of their nodes is joined
+    Flow::Scheduler shared(4);
+    std::vector<Flow::Graph> graphs(GraphCount);
+    for (auto &graph : graphs) {
+        for (auto i = 0; i < Count; ++i)
+            graph.emplace([&trigger] { ++trigger; });
+        graph.setRepeatCallback([runs = 0]() mutable { return ++runs != 3; });
+    }
+    for (auto &graph : graphs)
+        shared.schedule(graph);
+    for (auto &graph : graphs)
+        graph.wait();
+    ASSERT_EQ(trigger, 3 * GraphCount * Count);
+}
@@ -0,0 +1,112 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of Topology
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/Scheduler.hpp>
+
+using namespace kF;
+
+namespace
+{
+    /** @brief Write a fake sysfs tree: 2 sockets, each one being a NUMA node of 2 cores with 2 hardware threads */
+    std::filesystem::path WriteDualSocketSysfs(void)
+    {
+        const auto root = std::filesystem::temp_directory_path() / "KubeFlowTopology";
+        const auto write = [](const std::filesystem::path &path, const std::string &content) {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream(path) << content << '\n';
+        };
+
+        std::filesystem::remove_all(root);
+        write(root / "cpu/online", "0-7");
+        for (auto cpu = 0u; cpu < 8u; ++cpu) {
+            // Linux numbers the second hardware thread of every core after the first ones
+            const auto topology = root / "cpu" / ("cpu" + std::to_string(cpu)) / "topology";
+            write(topology / "core_id", std::to_string(cpu % 2u));
+            write(topology / "physical_package_id", std::to_string((cpu / 2u) % 2u));
+        }
+        write(root / "node/online", "0-1");
+        write(root / "node/node0/cpulist", "0-1,4-5");
+        write(root / "node/node1/cpulist", "2-3,6-7");
+        return root;
+    }
+}
+
+TEST(Topology, Load)
+{
+    const auto root = WriteDualSocketSysfs();
+    const auto topology = Flow::Topology::Load(root.string());
+    const auto &cpus = topology.cpus();
+
+    ASSERT_EQ(cpus.size(), 8u);
+    ASSERT_EQ(topology.nodeCount(), 2u);
+    for (auto i = 0u; i < cpus.size(); ++i) {
+        ASSERT_EQ(cpus[i].cpu, i);
+        ASSERT_EQ(cpus[i].core, i % 2u);
+        ASSERT_EQ(cpus[i].package, (i / 2u) % 2u);
+        ASSERT_EQ(cpus[i].node, cpus[i].package);
+    }
+    ASSERT_EQ(cpus[0].localityTo(cpus[4]), Flow::Locality::SameCore);
+    ASSERT_EQ(cpus[0].localityTo(cpus[1]), Flow::Locality::SameNode);
+    ASSERT_EQ(cpus[0].localityTo(cpus[2]), Flow::Locality::Remote);
+    std::filesystem::remove_all(root);
+}
+
+TEST(Topology, PlacementOrder)
+{
+    const auto root = WriteDualSocketSysfs();
+    const auto order = Flow::Topology::Load(root.string()).placementOrder();
+    constexpr std::uint32_t Expected[] = { 0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u };
+
+    // Physical cores of the first node, then the ones of the second node, then their second hardware thread
+    ASSERT_EQ(order.size(), 8u);
+    for (auto i = 0u; i < order.size(); ++i)
+        ASSERT_EQ(order[i].cpu, Expected[i]);
+    std::filesystem::remove_all(root);
+}
+
+TEST(Topology, SubNumaPackage)
+{
+    Core::Vector<Flow::CpuLocation> cpus;
+
+    cpus.push(Flow::CpuLocation { cpu: 0u, core: 0u, package: 0u, node: 0u });
+    cpus.push(Flow::CpuLocation { cpu: 1u, core: 1u, package: 0u, node: 1u });
+    cpus.push(Flow::CpuLocation { cpu: 2u, core: 0u, package: 1u, node: 2u });
+    const Flow::Topology topology(std::move(cpus));
+    ASSERT_EQ(topology.nodeCount(), 3u);
+    ASSERT_EQ(topology.cpus()[0].localityTo(topology.cpus()[1]), Flow::Locality::SamePackage);
+    ASSERT_EQ(topology.cpus()[0].localityTo(topology.cpus()[2]), Flow::Locality::Remote);
+}
+
+TEST(Topology, MissingSysfs)
+{
+    const auto topology = Flow::Topology::Load("/nonexistent/KubeFlow");
+
+    ASSERT_FALSE(topology.cpus().empty());
+    ASSERT_EQ(topology.nodeCount(), 1u);
+    ASSERT_FALSE(Flow::Topology::Detect().cpus().empty());
+}
+
+TEST(Topology, PinnedScheduler)
+{
+    constexpr auto Count = 1000;
+
+    for (const auto affinity : { Flow::Affinity::None, Flow::Affinity::Pinned }) {
+        Flow::Scheduler scheduler(4, Flow::Scheduler::DefaultTaskQueueSize, Flow::Scheduler::DefaultNotificationQueueSize, affinity);
+        Flow::Graph graph;
+        std::atomic<int> trigger = 0;
+
+        ASSERT_EQ(scheduler.affinity(), affinity);
+        for (auto i = 0; i < Count; ++i)
+            graph.emplace([&trigger] { ++trigger; });
+        scheduler.schedule(graph);
+        graph.wait();
+        ASSERT_EQ(trigger, Count);
+    }
+}
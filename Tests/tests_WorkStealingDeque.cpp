@@ -0,0 +1,66 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Unit tests of WorkStealingDeque
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Kube/Flow/WorkStealingDeque.hpp>
+
+using namespace kF;
+
+TEST(WorkStealingDeque, Grow)
+{
+    constexpr std::size_t Count = 100;
+    Flow::WorkStealingDeque<std::size_t> deque(4);
+    std::size_t value = 0;
+
+    ASSERT_EQ(deque.capacity(), 4);
+    for (auto i = 0ul; i < Count; ++i)
+        ASSERT_TRUE(deque.push(i));
+    ASSERT_EQ(deque.size(), Count);
+    ASSERT_EQ(deque.capacity(), 128);
+    ASSERT_TRUE(deque.steal(value));
+    ASSERT_EQ(value, 0);
+    for (auto i = Count - 1; i; --i) {
+        ASSERT_TRUE(deque.pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(deque.pop(value));
+    ASSERT_FALSE(deque.steal(value));
+}
+
+TEST(WorkStealingDeque, StealWhileGrowing)
+{
+    constexpr std::size_t Count = 100000;
+    constexpr std::size_t ThiefCount = 3;
+    Flow::WorkStealingDeque<std::size_t> deque(2);
+    std::vector<std::atomic<std::uint8_t>> seen(Count);
+    std::atomic<bool> done = false;
+    std::vector<std::thread> thieves;
+
+    for (auto i = 0ul; i < ThiefCount; ++i) {
+        thieves.emplace_back([&deque, &seen, &done] {
+            for (std::size_t value; !done.load() || deque.size();) {
+                if (deque.steal(value))
+                    ++seen[value];
+            }
+        });
+    }
+    // The owner pops a value out of four, so that the deque keeps growing while being stolen from
+    for (auto i = 0ul; i < Count; ++i) {
+        ASSERT_TRUE(deque.push(i));
+        if (std::size_t value; i % 4 == 0 && deque.pop(value))
+            ++seen[value];
+    }
+    done = true;
+    for (auto &thief : thieves)
+        thief.join();
+    for (std::size_t value; deque.pop(value); ++seen[value]);
+    for (const auto &count : seen)
+        ASSERT_EQ(count.load(), 1);
+}
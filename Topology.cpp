@@ -0,0 +1,192 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Hardware topology
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+#include "Topology.hpp"
+
+using namespace kF;
+
+namespace
+{
+    /** @brief Read the first line of a file, returns false if it can't be read */
+    bool ReadLine(const std::string &path, std::string &line)
+    {
+        std::ifstream file(path);
+
+        return file && std::getline(file, line);
+    }
+
+    /** @brief Read an integer from a file, negative or missing values are replaced by 'fallback' */
+    std::uint32_t ReadIndex(const std::string &path, const std::uint32_t fallback)
+    {
+        std::string line;
+
+        if (!ReadLine(path, line))
+            return fallback;
+        try {
+            const auto value = std::stol(line);
+            return value >= 0 ? static_cast<std::uint32_t>(value) : fallback;
+        } catch (...) {
+            return fallback;
+        }
+    }
+
+    /** @brief Parse a sysfs list of indexes (ex: "0-3,8,10-11") */
+    Core::Vector<std::uint32_t> ParseList(const std::string &line)
+    {
+        Core::Vector<std::uint32_t> indexes;
+        std::size_t pos = 0ul;
+
+        try {
+            while (pos < line.size()) {
+                std::size_t size = 0ul;
+                const auto first = std::stoul(line.substr(pos), &size);
+                auto last = first;
+                pos += size;
+                if (pos < line.size() && line[pos] == '-') {
+                    last = std::stoul(line.substr(pos + 1), &size);
+                    pos += size + 1;
+                }
+                for (auto index = first; index <= last; ++index)
+                    indexes.push(static_cast<std::uint32_t>(index));
+                if (pos < line.size() && line[pos] != ',')
+                    break;
+                ++pos;
+            }
+        } catch (...) {}
+        return indexes;
+    }
+}
+
+Flow::Locality Flow::CpuLocation::localityTo(const CpuLocation &other) const noexcept
+{
+    if (package == other.package && core == other.core)
+        return Locality::SameCore;
+    else if (node == other.node)
+        return Locality::SameNode;
+    else if (package == other.package)
+        return Locality::SamePackage;
+    else
+        return Locality::Remote;
+}
+
+Flow::Topology Flow::Topology::Detect(void)
+{
+    auto topology = Load();
+
+#if defined(__linux__)
+    // Containers and 'taskset' restrict the CPUs a process may use
+    if (cpu_set_t set; !sched_getaffinity(0, sizeof(set), &set)) {
+        Core::Vector<CpuLocation> allowed;
+        for (const auto &location : topology._cpus) {
+            if (location.cpu < CPU_SETSIZE && CPU_ISSET(location.cpu, &set))
+                allowed.push(location);
+        }
+        if (!allowed.empty())
+            topology._cpus = std::move(allowed);
+    }
+#endif
+    return topology;
+}
+
+Flow::Topology Flow::Topology::Load(const std::string_view &sysfsPath)
+{
+    const std::string root(sysfsPath);
+    Core::Vector<CpuLocation> cpus;
+    std::string line;
+
+    if (ReadLine(root + "/cpu/online", line)) {
+        for (const auto cpu : ParseList(line)) {
+            const auto path = root + "/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            cpus.push(CpuLocation {
+                cpu: cpu,
+                core: ReadIndex(path + "core_id", cpu),
+                package: ReadIndex(path + "physical_package_id", 0u),
+                node: 0u
+            });
+        }
+    } else {
+        for (auto cpu = 0u, count = std::max(std::thread::hardware_concurrency(), 1u); cpu < count; ++cpu)
+            cpus.push(CpuLocation { cpu: cpu, core: cpu, package: 0u, node: 0u });
+    }
+    // Machines without NUMA support don't have any node directory
+    if (ReadLine(root + "/node/online", line)) {
+        for (const auto node : ParseList(line)) {
+            if (std::string cpuList; ReadLine(root + "/node/node" + std::to_string(node) + "/cpulist", cpuList)) {
+                for (const auto cpu : ParseList(cpuList)) {
+                    const auto it = std::find_if(cpus.begin(), cpus.end(), [cpu](const auto &location) { return location.cpu == cpu; });
+                    if (it != cpus.end())
+                        it->node = node;
+                }
+            }
+        }
+    }
+    return Topology(std::move(cpus));
+}
+
+bool Flow::Topology::PinCurrentThread(const std::uint32_t cpu) noexcept
+{
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return !pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+std::size_t Flow::Topology::nodeCount(void) const noexcept
+{
+    std::size_t count { 0ul };
+
+    for (auto i = 0u; i < _cpus.size(); ++i) {
+        const auto node = _cpus[i].node;
+        if (std::none_of(_cpus.begin(), _cpus.begin() + i, [node](const auto &location) { return location.node == node; }))
+            ++count;
+    }
+    return count;
+}
+
+Core::Vector<Flow::CpuLocation> Flow::Topology::placementOrder(void) const
+{
+    struct Placement
+    {
+        CpuLocation location;
+        std::uint32_t thread; // Index of the hardware thread in its physical core
+    };
+
+    Core::Vector<Placement> placements;
+    Core::Vector<CpuLocation> order;
+
+    placements.reserve(_cpus.size());
+    for (const auto &location : _cpus) {
+        const auto thread = std::count_if(_cpus.begin(), _cpus.end(), [&location](const auto &other) {
+            return other.package == location.package && other.core == location.core && other.cpu < location.cpu;
+        });
+        placements.push(Placement { location: location, thread: static_cast<std::uint32_t>(thread) });
+    }
+    std::sort(placements.begin(), placements.end(), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.thread, lhs.location.node, lhs.location.package, lhs.location.core, lhs.location.cpu)
+            < std::tie(rhs.thread, rhs.location.node, rhs.location.package, rhs.location.core, rhs.location.cpu);
+    });
+    order.reserve(placements.size());
+    for (const auto &placement : placements)
+        order.push(placement.location);
+    return order;
+}
@@ -0,0 +1,89 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Hardware topology
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include <Kube/Core/Vector.hpp>
+
+namespace kF::Flow
+{
+    struct CpuLocation;
+    class Topology;
+
+    /** @brief Distance between two CPUs, from the closest to the farthest */
+    enum class Locality : std::uint8_t {
+        SameCore = 0u,  // Hardware threads of the same physical core
+        SameNode,       // Cores of the same NUMA node
+        SamePackage,    // NUMA nodes of the same socket
+        Remote          // Different sockets, or unknown placement
+    };
+
+    /** @brief Number of locality levels */
+    constexpr std::size_t LocalityCount { static_cast<std::size_t>(Locality::Remote) + 1ul };
+
+    /** @brief Placement of worker threads */
+    enum class Affinity : std::uint8_t {
+        None,   // Workers may run on any CPU, they steal from each other in random order
+        Pinned  // Each worker is pinned to a CPU and steals from the closest workers first
+    };
+}
+
+/** @brief Location of a logical CPU */
+struct kF::Flow::CpuLocation
+{
+    std::uint32_t cpu { 0u }; // Index of the CPU in the operating system
+    std::uint32_t core { 0u }; // Index of the physical core in its package
+    std::uint32_t package { 0u }; // Index of the socket
+    std::uint32_t node { 0u }; // Index of the NUMA node
+
+    /** @brief Get the locality between two CPUs */
+    [[nodiscard]] Locality localityTo(const CpuLocation &other) const noexcept;
+};
+
+/** @brief List of CPUs usable by the process and their location */
+class kF::Flow::Topology
+{
+public:
+    /** @brief Default root of the system devices in sysfs */
+    static constexpr std::string_view DefaultSysfsPath { "/sys/devices/system" };
+
+    /** @brief Detect the CPUs the current process is allowed to run on */
+    [[nodiscard]] static Topology Detect(void);
+
+    /** @brief Load every online CPU from a sysfs tree ('cpu' and 'node' directories)
+     *  Missing information falls back to one core per CPU, in a single package and NUMA node */
+    [[nodiscard]] static Topology Load(const std::string_view &sysfsPath = DefaultSysfsPath);
+
+    /** @brief Pin the current thread to a single CPU, returns false if unsupported or on failure */
+    static bool PinCurrentThread(const std::uint32_t cpu) noexcept;
+
+    /** @brief Construct an empty topology */
+    Topology(void) noexcept = default;
+
+    /** @brief Construct a topology from a list of CPUs */
+    explicit Topology(Core::Vector<CpuLocation> &&cpus) noexcept : _cpus(std::move(cpus)) {}
+
+    /** @brief Move constructor */
+    Topology(Topology &&other) noexcept = default;
+
+    /** @brief Move assignment */
+    Topology &operator=(Topology &&other) noexcept = default;
+
+    /** @brief Get the list of CPUs */
+    [[nodiscard]] const Core::Vector<CpuLocation> &cpus(void) const noexcept { return _cpus; }
+
+    /** @brief Get the number of distinct NUMA nodes */
+    [[nodiscard]] std::size_t nodeCount(void) const noexcept;
+
+    /** @brief Get the CPUs in the order workers should be placed on them
+     *  A single hardware thread of each physical core comes first, cores of a NUMA node being kept together,
+     *  then the remaining hardware threads in the same order */
+    [[nodiscard]] Core::Vector<CpuLocation> placementOrder(void) const;
+
+private:
+    Core::Vector<CpuLocation> _cpus {};
+};
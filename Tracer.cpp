@@ -0,0 +1,113 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Scheduler tracer
+ */
+
+#include <chrono>
+#include <cstring>
+
+#include "Tracer.hpp"
+
+using namespace kF;
+
+namespace
+{
+    std::int64_t SteadyClockNanoseconds(void) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void WriteEscapedName(std::ostream &stream, const Flow::TraceEvent &event)
+    {
+        static constexpr char HexDigits[] = "0123456789abcdef";
+
+        for (auto i = 0u; i < event.nameSize; ++i) {
+            const auto c = event.name[i];
+            if (c == '"' || c == '\\')
+                stream << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                stream << "\\u00" << HexDigits[(c >> 4) & 0xF] << HexDigits[c & 0xF];
+            else
+                stream << c;
+        }
+    }
+}
+
+Flow::Tracer::Tracer(const std::size_t workerCount, const std::size_t eventCapacity)
+    : _epoch(SteadyClockNanoseconds())
+{
+    _buffers.allocate(workerCount, eventCapacity);
+}
+
+std::uint64_t Flow::Tracer::now(void) const noexcept
+{
+    return static_cast<std::uint64_t>(SteadyClockNanoseconds() - _epoch);
+}
+
+void Flow::Tracer::record(const std::size_t workerId, const TraceEvent::Type type, const std::string_view &name,
+        const std::uint64_t begin, const std::uint64_t end) noexcept
+{
+    TraceEvent event;
+
+    event.begin = begin;
+    event.end = end;
+    event.workerId = static_cast<std::uint32_t>(workerId);
+    event.type = type;
+    auto nameSize = std::min(name.size(), TraceEvent::MaxNameSize);
+    // A truncated name is cut before the UTF-8 sequence it would split, continuation bytes are '10xxxxxx'
+    if (nameSize < name.size()) {
+        while (nameSize && (static_cast<unsigned char>(name[nameSize]) & 0xC0u) == 0x80u)
+            --nameSize;
+    }
+    event.nameSize = static_cast<std::uint8_t>(nameSize);
+    if (event.nameSize)
+        std::memcpy(event.name, name.data(), event.nameSize);
+    if (!_buffers[workerId].push(event)) [[unlikely]]
+        _droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Flow::Tracer::collect(Core::Vector<TraceEvent> &events)
+{
+    for (auto &buffer : _buffers) {
+        for (TraceEvent event; buffer.pop(event);)
+            events.push(event);
+    }
+}
+
+void Flow::Tracer::exportChromeTrace(std::ostream &stream)
+{
+    Core::Vector<TraceEvent> events;
+    bool first = true;
+
+    collect(events);
+    stream << "{\"traceEvents\":[";
+    for (const auto &event : events) {
+        if (!first)
+            stream << ',';
+        first = false;
+        stream << "{\"pid\":0,\"tid\":" << event.workerId << ",\"ts\":" << static_cast<double>(event.begin) / 1000.0;
+        switch (event.type) {
+        case TraceEvent::Type::Task:
+            stream << ",\"ph\":\"X\",\"cat\":\"task\",\"dur\":" << static_cast<double>(event.end - event.begin) / 1000.0 << ",\"name\":\"";
+            if (event.nameSize)
+                WriteEscapedName(stream, event);
+            else
+                stream << "Task";
+            stream << '"';
+            break;
+        case TraceEvent::Type::Steal:
+            stream << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"steal\",\"name\":\"Steal";
+            if (event.nameSize) {
+                stream << ' ';
+                WriteEscapedName(stream, event);
+            }
+            stream << '"';
+            break;
+        case TraceEvent::Type::Idle:
+            stream << ",\"ph\":\"X\",\"cat\":\"idle\",\"dur\":" << static_cast<double>(event.end - event.begin) / 1000.0 << ",\"name\":\"Idle\"";
+            break;
+        }
+        stream << '}';
+    }
+    stream << "],\"displayTimeUnit\":\"ns\"}";
+}
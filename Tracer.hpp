@@ -0,0 +1,78 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Scheduler tracer
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+#include <Kube/Core/HeapArray.hpp>
+#include <Kube/Core/SPSCQueue.hpp>
+#include <Kube/Core/Vector.hpp>
+
+namespace kF::Flow
+{
+    struct TraceEvent;
+    class Tracer;
+}
+
+/** @brief A single trace record, fits a cacheline */
+struct alignas_cacheline kF::Flow::TraceEvent
+{
+    /** @brief Type of event */
+    enum class Type : std::uint8_t {
+        Task,   // A task was executed between 'begin' and 'end'
+        Steal,  // A task was stolen at 'begin'
+        Idle    // The worker was sleeping between 'begin' and 'end'
+    };
+
+    std::uint64_t begin { 0u }; // Nanoseconds since tracer creation
+    std::uint64_t end { 0u }; // Nanoseconds since tracer creation
+    std::uint32_t workerId { 0u }; // Index of the worker that recorded the event
+    Type type { Type::Task }; // Type of event
+    std::uint8_t nameSize { 0u }; // Size of the name (truncated if longer than 'MaxNameSize')
+    char name[42]; // Name of the concerned node
+
+    /** @brief Maximum number of characters stored from a node name */
+    static constexpr std::size_t MaxNameSize { sizeof(name) };
+};
+
+static_assert_fit_cacheline(kF::Flow::TraceEvent);
+
+/**
+ * @brief Records scheduler events into a lock-free ring buffer per worker
+ *  Each buffer has a single producer (its worker) and a single consumer (the thread collecting events)
+ *  Events recorded while a buffer is full are dropped
+ */
+class kF::Flow::Tracer
+{
+public:
+    /** @brief Default number of events each worker can hold before they are collected */
+    static constexpr std::size_t DefaultEventCapacity { 16384ul };
+
+    /** @brief Construct a buffer for each worker */
+    Tracer(const std::size_t workerCount, const std::size_t eventCapacity);
+
+    /** @brief Get the current time in nanoseconds since tracer creation */
+    [[nodiscard]] std::uint64_t now(void) const noexcept;
+
+    /** @brief Record an event of a worker */
+    void record(const std::size_t workerId, const TraceEvent::Type type, const std::string_view &name,
+            const std::uint64_t begin, const std::uint64_t end) noexcept;
+
+    /** @brief Move every recorded event into a vector (only one thread can collect at a time) */
+    void collect(Core::Vector<TraceEvent> &events);
+
+    /** @brief Collect every recorded event and write them in Chrome trace format (JSON) */
+    void exportChromeTrace(std::ostream &stream);
+
+    /** @brief Get the number of events dropped because a buffer was full */
+    [[nodiscard]] std::size_t droppedCount(void) const noexcept { return _droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    Core::HeapArray<Core::SPSCQueue<TraceEvent>> _buffers {};
+    std::int64_t _epoch { 0 };
+    std::atomic<std::size_t> _droppedCount { 0ul };
+};
@@ -0,0 +1,141 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Work arena
+ */
+
+#pragma once
+
+// This header must no be directly included, include 'Graph' instead
+
+#include <Kube/Core/Vector.hpp>
+
+#include "BlockCache.hpp"
+#include "NodeType.hpp"
+
+namespace kF::Flow
+{
+    class WorkArena;
+
+    template<typename Work>
+    struct WorkReference;
+
+    /** @brief Where the work of a node is stored */
+    enum class WorkStorage : std::uint8_t {
+        Inline, // Inside the functor of the node
+        Arena,  // In the work arena of the graph, with its concrete type
+        Heap    // Allocated by the functor of the node
+    };
+
+    /** @brief Maximum size of a work stored inside the functor of its node */
+    constexpr std::size_t InlineWorkSize { 2ul * sizeof(void *) };
+
+    /** @brief Maximum size of a work stored in the work arena of a graph */
+    constexpr std::size_t ArenaWorkSize { 1024ul };
+
+    /** @brief Functors already erase the type of their work, they are never wrapped */
+    template<typename Work>
+    concept ErasedWork = std::is_same_v<std::remove_cvref_t<Work>, StaticFunc> || std::is_same_v<std::remove_cvref_t<Work>, DynamicFunc>
+        || std::is_same_v<std::remove_cvref_t<Work>, SwitchFunc> || std::is_same_v<std::remove_cvref_t<Work>, CoroutineFunc>;
+
+    /** @brief Any callable that can be the work or the notification of a node */
+    template<typename Work>
+    concept CallableWork = std::is_invocable_v<std::remove_cvref_t<Work> &> || std::is_invocable_v<std::remove_cvref_t<Work> &, Graph &>;
+
+    /** @brief Works small and trivial enough to be stored inside a functor without allocation */
+    template<typename Work>
+    concept InlineWork = ErasedWork<Work> || (sizeof(std::remove_cvref_t<Work>) <= InlineWorkSize
+        && alignof(std::remove_cvref_t<Work>) <= alignof(void *) && std::is_trivially_copyable_v<std::remove_cvref_t<Work>>);
+
+    /** @brief Works stored in the work arena of their graph when emplaced */
+    template<typename Work>
+    concept ArenaWork = CallableWork<Work> && !InlineWork<Work>
+        && sizeof(std::remove_cvref_t<Work>) <= ArenaWorkSize && alignof(std::remove_cvref_t<Work>) <= Core::CacheLineSize;
+
+    /** @brief Get where a work is stored once emplaced into a graph ('Graph::spawn' and 'Task::setWork' never use the arena) */
+    template<typename Work>
+    constexpr WorkStorage EmplacedWorkStorage = InlineWork<Work> ? WorkStorage::Inline : ArenaWork<Work> ? WorkStorage::Arena : WorkStorage::Heap;
+
+#if defined(KF_FLOW_REPORT_ALLOCATIONS)
+    /** @brief Instantiated for every node work allocated on the heap, the deprecation warning points to the allocating call */
+    template<typename Work>
+    [[deprecated("Flow: the work of this node is allocated on the heap, see 'Flow::EmplacedWorkStorage'")]]
+    constexpr void ReportHeapWork(void) noexcept {}
+#endif
+
+    /** @brief Report a work allocated on the heap at compile time, only if 'KF_FLOW_REPORT_ALLOCATIONS' is defined */
+    template<typename Work, WorkStorage Storage>
+    constexpr void ReportWorkStorage(void) noexcept
+    {
+#if defined(KF_FLOW_REPORT_ALLOCATIONS)
+        if constexpr (CallableWork<Work> && Storage == WorkStorage::Heap)
+            ReportHeapWork<std::remove_cvref_t<Work>>();
+#endif
+    }
+}
+
+/** @brief Reference to a work stored in an arena, small enough to be stored inline by any functor
+ *  It has the same call signatures as its work, so it is dispatched to the same node type */
+template<typename Work>
+struct kF::Flow::WorkReference
+{
+    Work *work { nullptr };
+
+    /** @brief Call the work with its concrete type */
+    template<typename ...Args>
+    auto operator()(Args &&...args) const -> decltype((*work)(std::forward<Args>(args)...))
+        { return (*work)(std::forward<Args>(args)...); }
+};
+
+/**
+ * @brief Bump arena in which the works of a graph that don't fit into their functor are constructed
+ *  Works keep their concrete type, those that aren't trivially destructible are destroyed in reverse order on 'clear'
+ *  Blocks are reused after 'clear' and come from per-thread caches like node slabs
+ */
+class kF::Flow::WorkArena
+{
+public:
+    /** @brief Size of a block, a work and its destructor record always fit in one */
+    static constexpr std::size_t BlockSize { 4096ul };
+
+    static_assert(ArenaWorkSize + 2ul * Core::CacheLineSize <= BlockSize, "Flow::WorkArena: Arena works must fit in a block");
+
+    /** @brief Default constructor */
+    WorkArena(void) noexcept = default;
+
+    /** @brief Arenas are bound to their graph */
+    WorkArena(const WorkArena &other) = delete;
+    WorkArena &operator=(const WorkArena &other) = delete;
+
+    /** @brief Destroy every work and release every block */
+    ~WorkArena(void) noexcept { release(); }
+
+    /** @brief Construct a work into the arena */
+    template<typename Work>
+    [[nodiscard]] std::remove_cvref_t<Work> *allocate(Work &&work);
+
+    /** @brief Destroy every work and reuse every block from start, nodes referencing them must have been destroyed */
+    void clear(void) noexcept;
+
+    /** @brief Destroy every work and give every block back to the cache of the current thread */
+    void release(void) noexcept;
+
+private:
+    /** @brief Record of a work to destroy */
+    struct Destructor
+    {
+        void (*destroy)(void *) { nullptr };
+        void *work { nullptr };
+        Destructor *previous { nullptr };
+    };
+
+    /** @brief Cache of blocks */
+    using BlockCache = Flow::BlockCache<BlockSize, Core::CacheLineSize>;
+
+    Core::TinyVector<std::byte *> _blocks {};
+    std::uint32_t _blockIndex { 0u };
+    std::uint32_t _used { 0u };
+    Destructor *_lastDestructor { nullptr };
+
+    /** @brief Reserve an aligned memory area in the current block, or in the next one */
+    [[nodiscard]] void *reserve(const std::size_t size, const std::size_t alignment);
+};
@@ -0,0 +1,55 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Work arena
+ */
+
+template<typename Work>
+inline std::remove_cvref_t<Work> *kF::Flow::WorkArena::allocate(Work &&work)
+{
+    using Type = std::remove_cvref_t<Work>;
+
+    // The destructor record is reserved first, a work throwing on construction leaves it unlinked
+    Destructor *destructor = nullptr;
+    if constexpr (!std::is_trivially_destructible_v<Type>)
+        destructor = static_cast<Destructor *>(reserve(sizeof(Destructor), alignof(Destructor)));
+    const auto instance = new (reserve(sizeof(Type), alignof(Type))) Type(std::forward<Work>(work));
+    if constexpr (!std::is_trivially_destructible_v<Type>) {
+        destructor->destroy = [](void * const instance) { static_cast<Type *>(instance)->~Type(); };
+        destructor->work = instance;
+        destructor->previous = _lastDestructor;
+        _lastDestructor = destructor;
+    }
+    return instance;
+}
+
+inline void *kF::Flow::WorkArena::reserve(const std::size_t size, const std::size_t alignment)
+{
+    auto offset = (static_cast<std::size_t>(_used) + alignment - 1ul) & ~(alignment - 1ul);
+
+    if (_blockIndex == _blocks.size() || offset + size > BlockSize) [[unlikely]] {
+        if (_blockIndex != _blocks.size())
+            ++_blockIndex;
+        if (_blockIndex == _blocks.size())
+            _blocks.push(static_cast<std::byte *>(BlockCache::Allocate()));
+        offset = 0ul;
+    }
+    _used = static_cast<std::uint32_t>(offset + size);
+    return _blocks[_blockIndex] + offset;
+}
+
+inline void kF::Flow::WorkArena::clear(void) noexcept
+{
+    for (auto destructor = _lastDestructor; destructor; destructor = destructor->previous)
+        destructor->destroy(destructor->work);
+    _lastDestructor = nullptr;
+    _blockIndex = 0u;
+    _used = 0u;
+}
+
+inline void kF::Flow::WorkArena::release(void) noexcept
+{
+    clear();
+    for (const auto block : _blocks)
+        BlockCache::Deallocate(block);
+    _blocks.clear();
+}
@@ -0,0 +1,77 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Work stealing deque
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <Kube/Core/HeapArray.hpp>
+
+namespace kF::Flow
+{
+    template<typename Type>
+    class WorkStealingDeque;
+}
+
+/**
+ * @brief Growable Chase-Lev work stealing deque
+ *  The owner thread pushes and pops at the bottom (LIFO) while any other thread steals from the top (FIFO)
+ *  Only the owner is allowed to call 'push' and 'pop'
+ *  A full deque moves its values into a buffer twice as large, previous buffers are kept until destruction
+ *  because thieves may still read from them (their total size never exceeds the one of the last buffer)
+ */
+template<typename Type>
+class alignas_double_cacheline kF::Flow::WorkStealingDeque
+{
+public:
+    static_assert(std::is_trivially_copyable_v<Type>, "Flow::WorkStealingDeque: Type must be trivially copyable");
+
+    /** @brief Construct the deque with an initial capacity (rounded up to the next power of 2) */
+    WorkStealingDeque(const std::size_t capacity);
+
+    /** @brief Destructor */
+    ~WorkStealingDeque(void) noexcept = default;
+
+    /** @brief Push a value at the bottom of the deque (owner only), returns false only if the deque failed to grow */
+    [[nodiscard]] bool push(const Type value) noexcept;
+
+    /** @brief Pop a value from the bottom of the deque (owner only) */
+    [[nodiscard]] bool pop(Type &value) noexcept;
+
+    /** @brief Steal a value from the top of the deque (any thread) */
+    [[nodiscard]] bool steal(Type &value) noexcept;
+
+    /** @brief Get the approximative count of values in the deque */
+    [[nodiscard]] std::size_t size(void) const noexcept;
+
+    /** @brief Get the current capacity of the deque */
+    [[nodiscard]] std::size_t capacity(void) const noexcept { return _buffer.load(std::memory_order_relaxed)->values.size(); }
+
+private:
+    /** @brief Circular array of values */
+    struct Buffer
+    {
+        Core::HeapArray<std::atomic<Type>> values {};
+        std::int64_t mask { 0 };
+        std::unique_ptr<Buffer> previous {}; // Buffer replaced by this one, thieves may still read from it
+
+        /** @brief Access the value at a deque index */
+        [[nodiscard]] std::atomic<Type> &at(const std::int64_t index) noexcept { return values[static_cast<std::size_t>(index & mask)]; }
+    };
+
+    alignas_cacheline std::atomic<std::int64_t> _top { 0 };
+    alignas_cacheline std::atomic<std::int64_t> _bottom { 0 };
+    alignas_cacheline std::atomic<Buffer *> _buffer { nullptr };
+    std::unique_ptr<Buffer> _storage {}; // Owns the last buffer and, through it, every previous one
+
+    /** @brief Allocate a buffer of a given capacity (a power of 2) */
+    [[nodiscard]] static std::unique_ptr<Buffer> AllocateBuffer(const std::size_t capacity);
+
+    /** @brief Move the values between 'top' and 'bottom' into a buffer twice as large (owner only) */
+    [[nodiscard]] Buffer *grow(const std::int64_t top, const std::int64_t bottom) noexcept;
+};
+
+#include "WorkStealingDeque.ipp"
@@ -0,0 +1,106 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Work stealing deque
+ */
+
+#include <bit>
+#include <new>
+
+template<typename Type>
+inline kF::Flow::WorkStealingDeque<Type>::WorkStealingDeque(const std::size_t capacity)
+    : _storage(AllocateBuffer(std::bit_ceil(capacity ? capacity : 1ul)))
+{
+    _buffer.store(_storage.get(), std::memory_order_relaxed);
+}
+
+template<typename Type>
+inline std::unique_ptr<typename kF::Flow::WorkStealingDeque<Type>::Buffer> kF::Flow::WorkStealingDeque<Type>::AllocateBuffer(const std::size_t capacity)
+{
+    auto buffer = std::make_unique<Buffer>();
+
+    buffer->values.allocate(capacity);
+    buffer->mask = static_cast<std::int64_t>(capacity - 1);
+    return buffer;
+}
+
+template<typename Type>
+inline typename kF::Flow::WorkStealingDeque<Type>::Buffer *kF::Flow::WorkStealingDeque<Type>::grow(const std::int64_t top, const std::int64_t bottom) noexcept
+{
+    const auto buffer = _buffer.load(std::memory_order_relaxed);
+    std::unique_ptr<Buffer> next;
+
+    try {
+        next = AllocateBuffer(buffer->values.size() * 2ul);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+    // Values keep their index, thieves reading the previous buffer still find the value they stole
+    for (auto index = top; index != bottom; ++index)
+        next->at(index).store(buffer->at(index).load(std::memory_order_relaxed), std::memory_order_relaxed);
+    next->previous = std::move(_storage);
+    _storage = std::move(next);
+    _buffer.store(_storage.get(), std::memory_order_release);
+    return _storage.get();
+}
+
+template<typename Type>
+inline bool kF::Flow::WorkStealingDeque<Type>::push(const Type value) noexcept
+{
+    const auto bottom = _bottom.load(std::memory_order_relaxed);
+    const auto top = _top.load(std::memory_order_acquire);
+    auto buffer = _buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > buffer->mask) [[unlikely]] {
+        if (buffer = grow(top, bottom); !buffer) [[unlikely]]
+            return false;
+    }
+    buffer->at(bottom).store(value, std::memory_order_relaxed);
+    // A release store rather than a release fence, so that thread sanitizer sees the pairing with thieves
+    _bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename Type>
+inline bool kF::Flow::WorkStealingDeque<Type>::pop(Type &value) noexcept
+{
+    const auto bottom = _bottom.load(std::memory_order_relaxed) - 1;
+
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = _top.load(std::memory_order_relaxed);
+    // Empty deque
+    if (top > bottom) {
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+    value = _buffer.load(std::memory_order_relaxed)->at(bottom).load(std::memory_order_relaxed);
+    if (top != bottom) [[likely]]
+        return true;
+    // Last value of the deque, race against thieves
+    const bool success = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return success;
+}
+
+template<typename Type>
+inline bool kF::Flow::WorkStealingDeque<Type>::steal(Type &value) noexcept
+{
+    auto top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = _bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+        return false;
+    // The buffer is loaded after 'bottom', so it is at least the one the value was pushed into
+    value = _buffer.load(std::memory_order_acquire)->at(top).load(std::memory_order_relaxed);
+    return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+template<typename Type>
+inline std::size_t kF::Flow::WorkStealingDeque<Type>::size(void) const noexcept
+{
+    const auto bottom = _bottom.load(std::memory_order_relaxed);
+    const auto top = _top.load(std::memory_order_relaxed);
+
+    return bottom > top ? static_cast<std::size_t>(bottom - top) : 0ul;
+}
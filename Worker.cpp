@@ -3,7 +3,8 @@
  * @ Description: Worker thread
  */
 
-#include <iostream>
+#include <chrono>
+#include <limits>
 
 #include "Scheduler.hpp"
 
@@ -14,60 +15,160 @@ Flow::Worker::Worker(Scheduler * const parent, const std::size_t queueSize)
         parent: parent,
         thd: std::thread()
     }),
-    _queue(queueSize)
+    _queues {
+        WorkStealingDeque<Task>(queueSize),
+        WorkStealingDeque<Task>(queueSize),
+        WorkStealingDeque<Task>(queueSize)
+    }
 {
+    static_assert(PriorityCount == 3, "Flow::Worker::Worker: Queues must be initialized for every priority level");
 }
 
 void Flow::Worker::run(void)
 {
+    _Current = this;
+    // Pinning is best effort, the worker still runs if the CPU was taken away from the process
+    if (_cache.cpu >= 0)
+        Topology::PinCurrentThread(static_cast<std::uint32_t>(_cache.cpu));
     while (state() == State::Running) [[likely]] {
-        if (Task task; _queue.pop(task) || _cache.parent->steal(task)) [[likely]]
+        // Held joins are counted before looking for other workers' tasks, a graph may be waiting for them
+        // (a failed acquisition may leave a task taken by another worker, it is cleared first)
+        if (Task task; acquire(task) || flushJoins(task = Task()) || spin(task)) [[likely]]
             work(task);
         else {
             auto s = State::Running;
             if (!_state.compare_exchange_weak(s, State::IDLE)) [[unlikely]]
                 continue;
+            const auto tracer = _cache.parent->activeTracer();
+            const auto idleBegin = tracer ? tracer->now() : 0u;
+            const auto idleClock = std::chrono::steady_clock::now();
+            _cache.parent->idleWorkerJoined();
+            // A producer may have missed the idle transition, check again before sleeping
+            if (_cache.parent->hasPendingTasks())
+                tryWakeUp();
             __cxx_atomic_wait(reinterpret_cast<State *>(&_state), State::IDLE, static_cast<int>(std::memory_order_relaxed));
+            _cache.parent->idleWorkerLeft();
+            WorkerCounters::Add(_counters.wakeUps);
+            WorkerCounters::Add(_counters.idleNanoseconds, static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idleClock).count()));
+            if (tracer) [[unlikely]]
+                tracer->record(_cache.id, TraceEvent::Type::Idle, std::string_view(), idleBegin, tracer->now());
         }
     }
-    _state = State::Stopped;
+    // Nodes released by the last joins are dropped like any task left in the queues
+    Task released;
+    flushJoins(released);
+    _Current = nullptr;
+    wakeUp(State::Stopped);
+}
+
+bool Flow::Worker::spin(Task &task) noexcept
+{
+    Backoff backoff(_cache.parent->spinCount());
+
+    _cache.parent->thiefJoined();
+    while (backoff.spin() && state() == State::Running) {
+        if (!acquire(task))
+            continue;
+        // Only the last spinning worker hands over, the others still look for the pending tasks
+        if (_cache.parent->thiefLeft() == 1)
+            handOver();
+        return true;
+    }
+    _cache.parent->thiefLeft();
+    // Producers that saw this worker spinning didn't wake anyone, look once more before parking
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!acquire(task))
+        return false;
+    handOver();
+    return true;
+}
+
+void Flow::Worker::handOver(void) noexcept
+{
+    if (_cache.parent->hasPendingTasks())
+        _cache.parent->wakeUpIdleWorker();
+}
+
+void Flow::Worker::measureCost(Node * const node, const std::chrono::steady_clock::time_point begin) noexcept
+{
+    const auto duration = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+
+    // Smooth the measures so that a single outlier doesn't reorder the whole graph
+    const auto cost = (static_cast<std::uint64_t>(node->cost) * 3u + duration) / 4u;
+    node->cost = static_cast<std::uint32_t>(std::min<std::uint64_t>(std::max<std::uint64_t>(cost, 1u), std::numeric_limits<std::uint32_t>::max()));
+}
+
+void Flow::Worker::sendNotification(const Task task)
+{
+    // Loop until parent scheduler accept the notification
+    for (Backoff backoff; !_cache.parent->notify(task) && state() == State::Running;) {
+        WorkerCounters::Add(_counters.notificationRetries);
+        if (Task other; acquire(other)) {
+            work(other);
+            backoff.reset();
+        } else
+            backoff.wait();
+    }
 }
 
 void Flow::Worker::work(Task &task)
 {
-    try {
+    Task current = task;
+
+    // A ready successor is executed right away instead of going through a queue (continuation passing)
+    while (current) {
+        Task next;
+        const auto tracer = _cache.parent->activeTracer();
+        const auto begin = tracer ? tracer->now() : 0u;
+        const auto measure = current.node()->root->measuringCosts();
+        // A task scheduled outside of its graph doesn't join it, the graph may be destroyed as soon as the work is done
+        const auto joining = current.node()->root->running();
+        const auto clock = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
         std::uint32_t joinCount;
-        switch (task.type()) {
-        case NodeType::Static:
-            joinCount = dispatchStaticNode(task.node());
-            break;
-        case NodeType::Dynamic:
-            joinCount = dispatchDynamicNode(task.node());
-            break;
-        case NodeType::Switch:
-            joinCount = dispatchSwitchNode(task.node());
-            break;
-        case NodeType::Graph:
-            joinCount = dispatchGraphNode(task.node());
-            break;
-        default:
-            throw std::logic_error("Flow::Worker::Work: Undefined node");
-        }
-        if (!task.hasNotification()) {
-            task.node()->root->childrenJoined(joinCount);
-            return;
+        // Joins held for another graph are counted first, so that its completion isn't delayed by this node
+        if (_cache.joinedGraph && _cache.joinedGraph != current.node()->root) [[unlikely]]
+            flushJoins(next);
+        _cache.current = current.node();
+        try {
+            switch (current.type()) {
+            case NodeType::Static:
+                joinCount = dispatchStaticNode(current.node(), next);
+                break;
+            case NodeType::Dynamic:
+                joinCount = dispatchDynamicNode(current.node(), next);
+                break;
+            case NodeType::Switch:
+                joinCount = dispatchSwitchNode(current.node(), next);
+                break;
+            case NodeType::Graph:
+                joinCount = dispatchGraphNode(current.node(), next);
+                break;
+            case NodeType::Coroutine:
+                joinCount = dispatchCoroutineNode(current.node(), next);
+                break;
+            default:
+                throw std::logic_error("Flow::Worker::Work: Undefined node");
+            }
+        } catch (...) {
+            // The exception cancels the graph and is rethrown by 'Graph::wait', the node is still joined
+            joinCount = dispatchFailedNode(current.node(), next);
         }
-        // If the task has notification, loop until parent scheduler accept it
-        while (!_cache.parent->notify(task) && state() == State::Running) {
-            if (Task task; _queue.pop(task) || _cache.parent->steal(task))
-                work(task);
-            else
-                std::this_thread::yield();
-        }
-        task.node()->root->childrenJoined(joinCount);
-    } catch (const std::exception &e) {
-        std::cout << "Flow::Worker::work: Exception thrown in task '" << task.name() << "': " << e.what() << std::endl;
-    } catch (...) {
-        std::cout << "Flow::Worker::work: Unknown exception thrown in task '" << task.name() << '\'' << std::endl;
+        _cache.current = nullptr;
+        if (!_cache.spawned.empty()) [[unlikely]]
+            releaseSpawnedNodes(next);
+        WorkerCounters::Add(_counters.executedTasks[static_cast<std::size_t>(current.type())]);
+        if (measure) [[unlikely]]
+            measureCost(current.node(), clock);
+        // The node must be recorded before joining, its graph may be destroyed right after
+        if (tracer) [[unlikely]]
+            tracer->record(_cache.id, TraceEvent::Type::Task, current.name(), begin, tracer->now());
+        // A pending graph or dynamic node notifies once its nested graph completes
+        if (joinCount && current.hasNotification())
+            sendNotification(current);
+        if (joining) [[likely]]
+            joinNodes(current.node(), joinCount, next);
+        current = next;
     }
-}
\ No newline at end of file
+}
@@ -8,10 +8,16 @@
 // This header must no be directly included, include 'Scheduler' instead
 
 #include <atomic_wait>
+#include <chrono>
 
+#include <Kube/Core/HeapArray.hpp>
 #include <Kube/Core/MPMCQueue.hpp>
 
 #include "Graph.hpp"
+#include "WorkStealingDeque.hpp"
+#include "Stats.hpp"
+#include "Backoff.hpp"
+#include "Topology.hpp"
 
 namespace kF::Flow
 {
@@ -30,14 +36,26 @@ public:
         Stopped,    // Worker is stopped
     };
 
+    /** @brief Other workers to steal from, grouped by locality */
+    struct StealOrder
+    {
+        Core::HeapArray<std::uint32_t> victims {}; // Indexes of the other workers, from the closest to the farthest
+        std::uint32_t groupEnds[LocalityCount - 1] {}; // End of each locality group in 'victims', except the remote one ending with it
+        std::uint32_t seed { 1u }; // State of the generator picking the first victim of a group (never 0)
+
+        /** @brief Get the next pseudo-random number (xorshift) */
+        [[nodiscard]] std::uint32_t random(void) noexcept
+            { seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5; return seed; }
+    };
+
     /** @brief Construct and start the worker */
     Worker(Scheduler * const parent, const std::size_t queueSize);
 
     /** @brief Destroy the worker without stopping it ! */
     ~Worker(void) = default;
 
-    /** @brief Start the worker */
-    void start(void);
+    /** @brief Start the worker with its index in the scheduler, pinned to 'cpu' if it isn't negative */
+    void start(const std::size_t id, const std::int32_t cpu = -1);
 
     /** @brief Stop the worker */
     void stop(void) noexcept;
@@ -45,57 +63,166 @@ public:
     /** @brief Join the worker */
     void join(void) noexcept;
 
+    /** @brief Get the worker running on the current thread (null if not called from a worker) */
+    [[nodiscard]] static Worker *Current(void) noexcept { return _Current; }
+
+    /** @brief Get the index of the worker in its scheduler */
+    [[nodiscard]] std::size_t id(void) const noexcept { return _cache.id; }
+
+    /** @brief Get the CPU the worker is pinned to (negative if not pinned) */
+    [[nodiscard]] std::int32_t cpu(void) const noexcept { return _cache.cpu; }
+
+    /** @brief Get the scheduler owning the worker */
+    [[nodiscard]] Scheduler &parent(void) noexcept { return *_cache.parent; }
+
     /** @brief Get internal state of worker */
     [[nodiscard]] State state(void) noexcept { return _state.load(std::memory_order_relaxed); }
 
-    /** @brief Push a task to be processed on the worker thread */
-    [[nodiscard]] bool push(const Task task) noexcept { return _queue.push(task); }
+    /** @brief Push a task to be processed on the worker thread (only called by the worker thread itself) */
+    [[nodiscard]] bool push(const Task task) noexcept { return queue(task.priority()).push(task); }
+
+    /** @brief Update the queue high water counter after a batch of tasks was pushed (only called by the worker thread itself) */
+    void batchPushed(void) noexcept;
 
-    /** @brief Try to steal a task from worker */
-    [[nodiscard]] bool steal(Task &task) noexcept { return _queue.pop(task); }
+    /** @brief Try to steal a task of a given priority from worker */
+    [[nodiscard]] bool steal(Task &task, const Priority priority) noexcept { return queue(priority).steal(task); }
 
-    /** @brief Get the task count of the queue */
-    [[nodiscard]] std::size_t taskCount(void) const noexcept { return _queue.size(); }
+    /** @brief Take a snapshot of the worker counters */
+    [[nodiscard]] WorkerStats stats(void) const noexcept { return _counters.snapshot(); }
+
+    /** @brief Get the task count of every queue */
+    [[nodiscard]] std::size_t taskCount(void) const noexcept;
 
     /** @brief Notify that the worker should work right now */
     void wakeUp(const State state) noexcept;
 
+    /** @brief Wake up the worker only if it is IDLE, returns true on success */
+    bool tryWakeUp(void) noexcept;
+
+    /** @brief Get the node whose work is being executed by the worker (null outside of a node work)
+     *  Reserved for internal use ! */
+    [[nodiscard]] Node *currentNode(void) noexcept { return _cache.current; }
+
+    /** @brief Register a node spawned by the current node, it is released once the work of the current node returns
+     *  Reserved for internal use ! */
+    void spawnNode(Node * const node);
+
+    /** @brief Make the successors of the current node wait for a node it spawned
+     *  Reserved for internal use ! */
+    void deferSuccessors(Node * const spawned);
+
+    /** @brief Get the order in which the worker steals from others (only modified before start or by the worker thread)
+     *  Reserved for internal use ! */
+    [[nodiscard]] StealOrder &stealOrder(void) noexcept { return _cache.stealOrder; }
+
 private:
     struct Cache
     {
         Scheduler *parent { nullptr };
         std::thread thd {};
+        std::size_t id { 0ul };
+        StealOrder stealOrder {};
+        std::int32_t cpu { -1 };
+        Node *current { nullptr }; // Node being executed
+        Core::TinyVector<Node *> spawned {}; // Nodes spawned by the current node, not released yet
+        Core::TinyVector<Task> admitted {}; // Roots made ready by the admission of a pipelined iteration
+        Graph *joinedGraph { nullptr }; // Graph of the joins not yet counted by its completion counter
+        std::uint32_t joinCount { 0u }; // Number of joins not yet counted
     };
 
     alignas_cacheline std::atomic<State> _state { State::Stopped };
     alignas_cacheline Cache _cache {};
-    Core::MPMCQueue<Task> _queue;
+    WorkStealingDeque<Task> _queues[PriorityCount]; // One queue per priority level
+    WorkerCounters _counters {};
+
+    static inline thread_local Worker *_Current { nullptr };
+
+    /** @brief Get the queue of a priority level */
+    [[nodiscard]] WorkStealingDeque<Task> &queue(const Priority priority) noexcept
+        { return _queues[static_cast<std::size_t>(priority)]; }
 
     /** @brief Busy loop */
     void run(void);
 
+    /** @brief Look for tasks during the spinning rounds of the idle policy, before parking */
+    [[nodiscard]] bool spin(Task &task) noexcept;
+
+    /** @brief Wake up a sleeping worker if more tasks are pending once a spinning one found its task */
+    void handOver(void) noexcept;
+
+    /** @brief Update the cost of a node with the time elapsed since 'begin' */
+    static void measureCost(Node * const node, const std::chrono::steady_clock::time_point begin) noexcept;
+
+    /** @brief Send the notification of a task to the scheduler, processing other tasks while its queue is full */
+    void sendNotification(const Task task);
+
     /** @brief Execute a task */
     void work(Task &task);
 
+    /** @brief Tries to acquire the highest priority task, from the local queues, the scheduler or by stealing */
+    [[nodiscard]] bool acquire(Task &task) noexcept;
+
+    /** @brief Tries to acquire a task of a single priority level */
+    [[nodiscard]] bool acquire(Task &task, const Priority priority) noexcept;
+
 private:
-    /** @brief Work untile given graph finished */
-    void blockingGraphSchedule(Graph &graph);
+    /** @brief Schedule a nested graph whose completion will release the successors of 'parent'
+     *  Returns false if the graph is empty, in which case the parent node is done right away */
+    [[nodiscard]] bool scheduleNestedGraph(Node * const parent, Graph &graph, Task &next);
+
+    /** @brief Join 'joinCount' nodes into the root graph of a node
+     *  Joins are held by the worker and counted at once when it leaves the graph (see 'flushJoins') */
+    void joinNodes(Node * const node, const std::uint32_t joinCount, Task &next);
+
+    /** @brief Count the joins held by this worker into the completion counter of their graph
+     *  Returns true if 'next' holds a task, completed nested graphs release the successors of their parent node */
+    bool flushJoins(Task &next);
+
+    /** @brief Join a node into its iteration of a pipelined graph, then release the next iteration of the node */
+    void joinPipelinedNode(Node * const node, const CompiledGraph &compiled, Task &next);
 
-    /** @brief Tries to schedule a single node */
-    void scheduleNode(Node * const node);
+    /** @brief Count the admission of an iteration to every root of a pipelined graph, ready roots are scheduled at once */
+    void admitIteration(const Graph &graph, const CompiledGraph &compiled, const std::uint64_t iteration);
+
+    /** @brief Tries to schedule a single node which has 'dependencyCount' predecessors
+     *  If 'next' is empty, the ready node is stored into it instead of being queued */
+    void scheduleNode(Node * const node, const std::uint32_t dependencyCount, Task &next);
+
+    /** @brief Schedule a node whose predecessors are all done, it is kept as continuation or queued */
+    void scheduleReadyNode(Node * const node, Task &next);
+
+    /** @brief Tries to schedule every successor of a node */
+    void scheduleSuccessors(Node * const node, Task &next);
+
+    /** @brief Helper used to call 'functor' with every successor of a node */
+    template<typename Functor>
+    static void ForEachSuccessor(Node * const node, Functor &&functor);
+
+    /** @brief Release the nodes spawned by the current node, those without spawned predecessor are scheduled */
+    void releaseSpawnedNodes(Task &next);
+
+    /** @brief Check if the work of a node must be skipped (bypassed node or cancelled graph) */
+    [[nodiscard]] static bool IsSkipped(const Node * const node) noexcept
+        { return node->bypass.load() || node->root->cancelled(); }
+
+    /** @brief Helper used to fail the graph of a node whose dispatch threw the current exception */
+    [[nodiscard]] std::uint32_t dispatchFailedNode(Node * const node, Task &next);
 
     /** @brief Helper used to process a Static node */
-    [[nodiscard]] std::uint32_t dispatchStaticNode(Node * const node);
+    [[nodiscard]] std::uint32_t dispatchStaticNode(Node * const node, Task &next);
 
     /** @brief Helper used to process a Dynamic node */
-    [[nodiscard]] std::uint32_t dispatchDynamicNode(Node * const node);
+    [[nodiscard]] std::uint32_t dispatchDynamicNode(Node * const node, Task &next);
 
     /** @brief Helper used to process a Switch node */
-    [[nodiscard]] std::uint32_t dispatchSwitchNode(Node * const node);
+    [[nodiscard]] std::uint32_t dispatchSwitchNode(Node * const node, Task &next);
 
     /** @brief Helper used to process a Graph node */
-    [[nodiscard]] std::uint32_t dispatchGraphNode(Node * const node);
+    [[nodiscard]] std::uint32_t dispatchGraphNode(Node * const node, Task &next);
+
+    /** @brief Helper used to start or resume a Coroutine node */
+    [[nodiscard]] std::uint32_t dispatchCoroutineNode(Node * const node, Task &next);
 };
 
-static_assert_sizeof(kF::Flow::Worker, 6 * kF::Core::CacheLineSize);
+static_assert_sizeof(kF::Flow::Worker, (6 + 4 * kF::Flow::PriorityCount) * kF::Core::CacheLineSize);
 static_assert_alignof_double_cacheline(kF::Flow::Worker);
@@ -3,12 +3,14 @@
  * @ Description: Worker
  */
 
-inline void kF::Flow::Worker::start(void)
+inline void kF::Flow::Worker::start(const std::size_t id, const std::int32_t cpu)
 {
     const auto state = _state.load();
 
     if (state != State::Stopped)
         throw std::logic_error("Flow::Worker::start: Worker already running");
+    _cache.id = id;
+    _cache.cpu = cpu;
     _state = State::Running;
     _cache.thd = std::thread([this] { run(); });
 }
@@ -30,19 +32,104 @@ inline void kF::Flow::Worker::stop(void) noexcept
 
 inline void kF::Flow::Worker::join(void) noexcept
 {
-    while (state() != State::Stopped) { // To be replaced by atomic wait when available
-        std::this_thread::yield();
-    }
+    for (auto current = state(); current != State::Stopped; current = state())
+        __cxx_atomic_wait(reinterpret_cast<State *>(&_state), current, static_cast<int>(std::memory_order_relaxed));
     if (_cache.thd.joinable())
         _cache.thd.join();
 }
 
-inline void kF::Flow::Worker::scheduleNode(Node * const node)
+inline void kF::Flow::Worker::scheduleNode(Node * const node, const std::uint32_t dependencyCount, Task &next)
 {
-    if (const auto count = node->linkedFrom.size(); count && count == ++node->joined) {
+    if (dependencyCount && dependencyCount == ++node->joined) {
         node->joined = 0;
-        _cache.parent->schedule(node);
+        scheduleReadyNode(node, next);
+    }
+}
+
+inline void kF::Flow::Worker::scheduleReadyNode(Node * const node, Task &next)
+{
+    if (!next) {
+        next = node;
+        return;
     }
+    // The most urgent ready node is kept as continuation, then the one with the longest path to a sink
+    Task task(node);
+    if (task.priority() < next.priority() || (task.priority() == next.priority() && task.rank() > next.rank()))
+        std::swap(task, next);
+    // Other successors are kept on the local deque so they stay on this core unless stolen
+    // (a queued node may run and be released right away, it isn't read once pushed)
+    if (const auto priority = task.priority(); this->queue(priority).push(task)) [[likely]] {
+        WorkerCounters::Max(_counters.queueHighWater, this->queue(priority).size());
+        if (priority != Priority::Normal)
+            _cache.parent->prioritizedTaskQueued();
+        _cache.parent->wakeUpIdleWorker();
+    } else
+        _cache.parent->schedule(task);
+}
+
+inline void kF::Flow::Worker::scheduleSuccessors(Node * const node, Task &next)
+{
+    // Frozen graphs only read contiguous arrays, without touching the successors until they are ready
+    if (const auto compiled = node->root->compiled(); compiled && !node->spawned) {
+        const auto index = compiled->indexOf(node);
+        // Successors of a pipelined graph are counted for the iteration the node ran
+        if (const auto pipeline = compiled->pipelineState(); pipeline) {
+            const auto iteration = pipeline->iterations[index];
+            for (auto it = compiled->successorsBegin(index), end = compiled->successorsEnd(index); it != end; ++it) {
+                if (pipeline->arrive(*it, iteration))
+                    scheduleReadyNode(compiled->nodes + *it, next);
+            }
+        } else {
+            for (auto it = compiled->successorsBegin(index), end = compiled->successorsEnd(index); it != end; ++it)
+                scheduleNode(compiled->nodes + *it, compiled->inDegrees[*it], next);
+        }
+    } else {
+        for (Node * const link : node->linkedTo)
+            scheduleNode(link, link->linkedFrom.size(), next);
+    }
+}
+
+template<typename Functor>
+inline void kF::Flow::Worker::ForEachSuccessor(Node * const node, Functor &&functor)
+{
+    if (const auto compiled = node->root->compiled(); compiled && !node->spawned) {
+        const auto index = compiled->indexOf(node);
+        for (auto it = compiled->successorsBegin(index), end = compiled->successorsEnd(index); it != end; ++it)
+            functor(compiled->nodes + *it);
+    } else {
+        for (Node * const link : node->linkedTo)
+            functor(link);
+    }
+}
+
+inline void kF::Flow::Worker::spawnNode(Node * const node)
+{
+    // The expansion inherits the rank of its node, so that it stays on the critical path
+    node->root = _cache.current->root;
+    node->rank = _cache.current->rank;
+    node->spawned = true;
+    _cache.spawned.push(node);
+}
+
+inline void kF::Flow::Worker::deferSuccessors(Node * const spawned)
+{
+    kFAssert(std::find(_cache.spawned.begin(), _cache.spawned.end(), spawned) != _cache.spawned.end(),
+        throw std::logic_error("Flow::Worker::deferSuccessors: Only a node spawned by the current node can defer its successors"));
+    // Successors can't be ready before the current node releases them, one more arrival is required from the spawned node
+    ForEachSuccessor(_cache.current, [spawned](Node * const successor) {
+        --successor->joined;
+        spawned->linkedTo.push(successor);
+    });
+}
+
+inline void kF::Flow::Worker::releaseSpawnedNodes(Task &next)
+{
+    // Spawned nodes with predecessors are released by them
+    for (const auto node : _cache.spawned) {
+        if (node->linkedFrom.empty())
+            scheduleNode(node, 1u, next);
+    }
+    _cache.spawned.clear();
 }
 
 inline void kF::Flow::Worker::wakeUp(const State state) noexcept
@@ -51,38 +138,195 @@ inline void kF::Flow::Worker::wakeUp(const State state) noexcept
     __cxx_atomic_notify_all(reinterpret_cast<State *>(&_state));
 }
 
-inline void kF::Flow::Worker::blockingGraphSchedule(Graph &graph)
+inline bool kF::Flow::Worker::tryWakeUp(void) noexcept
 {
-    _cache.parent->schedule(graph);
-    while (graph.running() && state() == State::Running) {
-        if (Task task; _queue.pop(task) || _cache.parent->steal(task))
-            work(task);
-        else
-            std::this_thread::yield();
+    auto expected = State::IDLE;
+
+    if (!_state.compare_exchange_strong(expected, State::Running))
+        return false;
+    __cxx_atomic_notify_all(reinterpret_cast<State *>(&_state));
+    return true;
+}
+
+inline void kF::Flow::Worker::batchPushed(void) noexcept
+{
+    for (const auto &queue : _queues)
+        WorkerCounters::Max(_counters.queueHighWater, queue.size());
+}
+
+inline std::size_t kF::Flow::Worker::taskCount(void) const noexcept
+{
+    std::size_t count { 0ul };
+
+    for (const auto &queue : _queues)
+        count += queue.size();
+    return count;
+}
+
+inline bool kF::Flow::Worker::acquire(Task &task) noexcept
+{
+    // Without any queued high or low priority task, only the normal level is looked at
+    if (!_cache.parent->hasPrioritizedTasks()) [[likely]] {
+        if (acquire(task, Priority::Normal))
+            return true;
+    } else {
+        // A level is exhausted everywhere (local, shared and other workers) before looking at the next one
+        for (auto level = 0ul; level < PriorityCount; ++level) {
+            if (const auto priority = static_cast<Priority>(level); acquire(task, priority)) {
+                if (priority != Priority::Normal)
+                    _cache.parent->prioritizedTaskAcquired();
+                return true;
+            }
+        }
     }
+    WorkerCounters::Add(_counters.failedSteals);
+    return false;
 }
 
-inline std::uint32_t kF::Flow::Worker::dispatchStaticNode(Node * const node)
+inline bool kF::Flow::Worker::acquire(Task &task, const Priority priority) noexcept
 {
-    if (!node->bypass.load()) [[likely]]
+    if (queue(priority).pop(task) || _cache.parent->pop(task, priority, *this))
+        return true;
+    else if (!_cache.parent->steal(task, priority, *this))
+        return false;
+    WorkerCounters::Add(_counters.steals);
+    if (const auto tracer = _cache.parent->activeTracer(); tracer) [[unlikely]] {
+        const auto now = tracer->now();
+        tracer->record(_cache.id, TraceEvent::Type::Steal, task.name(), now, now);
+    }
+    return true;
+}
+
+inline bool kF::Flow::Worker::scheduleNestedGraph(Node * const parent, Graph &graph, Task &next)
+{
+    if (!graph.size())
+        return false;
+    else if (graph.running())
+        throw std::logic_error("Flow::Worker::scheduleNestedGraph: Can't schedule a graph if it is already running");
+    else if (graph.repeatMode() == RepeatMode::Pipelined)
+        throw std::logic_error("Flow::Worker::scheduleNestedGraph: A pipelined graph can't be nested");
+    graph.preprocess();
+    graph.resetCancellation();
+    graph.setParent(parent);
+    graph.setScheduler(_cache.parent);
+    graph.setRunning(true);
+    // Roots are kept on this worker like any other successor
+    for (auto root : graph.roots())
+        scheduleNode(root.node(), 1u, next);
+    return true;
+}
+
+inline void kF::Flow::Worker::joinNodes(Node * const node, const std::uint32_t joinCount, Task &next)
+{
+    const auto root = node->root;
+
+    if (!joinCount)
+        return;
+    // Nodes of a pipelined graph are static nodes of a top-level graph, they only join their iteration
+    if (const auto compiled = root->compiled(); compiled && compiled->pipelineState()) {
+        joinPipelinedNode(node, *compiled, next);
+        return;
+    }
+    // Spawned nodes are not children of their graph, they are released before the graph may complete
+    if (node->spawned) [[unlikely]]
+        NodeArena::DeallocateNode(node);
+    // The completion counter of a graph is only touched when a worker leaves it, not by every worker on each node
+    if (_cache.joinedGraph != root) {
+        // Notifications sent while flushing may run nodes holding joins of their own
+        while (_cache.joinedGraph && _cache.joinedGraph != root)
+            flushJoins(next);
+        _cache.joinedGraph = root;
+    }
+    _cache.joinCount += joinCount;
+}
+
+inline bool kF::Flow::Worker::flushJoins(Task &next)
+{
+    auto graph = std::exchange(_cache.joinedGraph, nullptr);
+    auto count = std::exchange(_cache.joinCount, 0u);
+
+    // Each nested graph completed this way releases the successors of its parent node, without recursion
+    for (; graph; count = 1u) {
+        const auto parent = graph->childrenJoined(count);
+        if (!parent)
+            break;
+        // A coroutine awaiting the completed graph is resumed instead of being done
+        if (parent->workData.index() == static_cast<std::size_t>(NodeType::Coroutine)) {
+            scheduleNode(parent, 1u, next);
+            break;
+        }
+        scheduleSuccessors(parent, next);
+        if (Task task(parent); task.hasNotification())
+            sendNotification(task);
+        graph = parent->root;
+    }
+    return static_cast<bool>(next);
+}
+
+inline void kF::Flow::Worker::joinPipelinedNode(Node * const node, const CompiledGraph &compiled, Task &next)
+{
+    const auto root = node->root;
+    const auto index = compiled.indexOf(node);
+    auto &pipeline = *compiled.pipelineState();
+    const auto iteration = pipeline.iterations[index];
+    // The graph may be destroyed by the join of its last iteration, so the next one is checked first
+    const auto repeated = pipeline.planned(iteration + 1u);
+
+    if (root->iterationJoined(iteration))
+        admitIteration(*root, compiled, iteration + 2u);
+    // The next iteration of the node waits for this one to be joined, so that iterations complete in order
+    if (repeated && pipeline.arrive(index, iteration + 1u))
+        scheduleReadyNode(node, next);
+}
+
+inline void kF::Flow::Worker::admitIteration(const Graph &graph, const CompiledGraph &compiled, const std::uint64_t iteration)
+{
+    auto &pipeline = *compiled.pipelineState();
+
+    for (const auto root : graph.roots()) {
+        if (pipeline.arrive(compiled.indexOf(root.node()), iteration))
+            _cache.admitted.push(root);
+    }
+    _cache.parent->schedule(std::span<const Task>(_cache.admitted.begin(), _cache.admitted.end()));
+    _cache.admitted.clear();
+}
+
+inline std::uint32_t kF::Flow::Worker::dispatchFailedNode(Node * const node, Task &next)
+{
+    node->root->fail(std::current_exception());
+    // Successors are released as if the node succeeded, the cancelled graph skips their work
+    scheduleSuccessors(node, next);
+    return 1u;
+}
+
+inline std::uint32_t kF::Flow::Worker::dispatchStaticNode(Node * const node, Task &next)
+{
+    if (!IsSkipped(node)) [[likely]]
         std::get<static_cast<std::size_t>(NodeType::Static)>(node->workData)();
-    for (Node * const link : node->linkedTo)
-        scheduleNode(link);
+    scheduleSuccessors(node, next);
     return 1u;
 }
 
-inline std::uint32_t kF::Flow::Worker::dispatchDynamicNode(Node * const node)
+inline std::uint32_t kF::Flow::Worker::dispatchDynamicNode(Node * const node, Task &next)
 {
-    if (!node->bypass.load()) [[likely]] {
+    if (!IsSkipped(node)) [[likely]] {
         auto &dynamic = std::get<static_cast<std::size_t>(NodeType::Dynamic)>(node->workData);
         dynamic.func(dynamic.graph);
-        blockingGraphSchedule(dynamic.graph);
+        // The node is joined once its graph completes
+        if (scheduleNestedGraph(node, dynamic.graph, next))
+            return 0u;
     }
+    scheduleSuccessors(node, next);
     return 1u;
 }
 
-inline std::uint32_t kF::Flow::Worker::dispatchSwitchNode(Node * const node)
+inline std::uint32_t kF::Flow::Worker::dispatchSwitchNode(Node * const node, Task &next)
 {
+    // A cancelled switch releases every branch, so that each node is still joined once
+    if (node->root->cancelled()) [[unlikely]] {
+        scheduleSuccessors(node, next);
+        return 1u;
+    }
     auto &switchTask = std::get<static_cast<std::size_t>(NodeType::Switch)>(node->workData);
     const auto index = switchTask.func();
     const auto count = node->linkedTo.size();
@@ -94,7 +338,8 @@ inline std::uint32_t kF::Flow::Worker::dispatchSwitchNode(Node * const node)
         throw std::logic_error("Invalid switch task return index"));
     kFAssert(switchTask.joinCounts.size() == count,
         throw std::logic_error("Invalid switch task preprocessing, expected " + std::to_string(count) + " join counts but have " + std::to_string(switchTask.joinCounts.size())));
-    scheduleNode(node->linkedTo[index]);
+    const auto target = node->linkedTo[index];
+    scheduleNode(target, target->linkedFrom.size(), next);
     for (std::size_t i = 0; i < count; ++i) {
         if (i != index)
             joinCount += switchTask.joinCounts[i];
@@ -104,13 +349,61 @@ inline std::uint32_t kF::Flow::Worker::dispatchSwitchNode(Node * const node)
     return joinCount;
 }
 
-inline std::uint32_t kF::Flow::Worker::dispatchGraphNode(Node * const node)
+inline std::uint32_t kF::Flow::Worker::dispatchGraphNode(Node * const node, Task &next)
 {
-    if (!node->bypass.load()) [[likely]] {
+    if (!IsSkipped(node)) [[likely]] {
         auto &graph = std::get<static_cast<std::size_t>(NodeType::Graph)>(node->workData);
-        blockingGraphSchedule(graph);
+        // The node is joined once its graph completes
+        if (scheduleNestedGraph(node, graph, next))
+            return 0u;
     }
-    for (const auto link : node->linkedTo)
-        scheduleNode(link);
+    scheduleSuccessors(node, next);
     return 1u;
-}
\ No newline at end of file
+}
+
+inline std::uint32_t kF::Flow::Worker::dispatchCoroutineNode(Node * const node, Task &next)
+{
+    auto &coroutine = std::get<static_cast<std::size_t>(NodeType::Coroutine)>(node->workData);
+
+    if (!coroutine.handle) {
+        if (IsSkipped(node)) [[unlikely]] {
+            scheduleSuccessors(node, next);
+            return 1u;
+        }
+        coroutine.handle = coroutine.func().release();
+    }
+    const auto handle = Coroutine::Handle::from_address(coroutine.handle.address());
+    auto &promise = handle.promise();
+    promise.node = node;
+    promise.scheduler = _cache.parent;
+    promise.arrivals.store(0u, std::memory_order_relaxed);
+    handle.resume();
+
+    // The body returned, the node is done
+    if (handle.done()) {
+        const auto exception = std::move(promise.exception);
+        coroutine.handle.destroy();
+        coroutine.handle = nullptr;
+        if (exception) [[unlikely]]
+            std::rethrow_exception(exception);
+        scheduleSuccessors(node, next);
+        return 1u;
+    }
+    // Suspended on a graph, resumed by the completion of the graph
+    if (const auto graph = std::exchange(promise.awaitedGraph, nullptr); graph) {
+        bool scheduled;
+        try {
+            scheduled = scheduleNestedGraph(node, *graph, next);
+        } catch (...) {
+            // The frame is never resumed, the next run of the node starts its body again
+            coroutine.handle.destroy();
+            coroutine.handle = nullptr;
+            throw;
+        }
+        if (!scheduled)
+            scheduleNode(node, 1u, next);
+    // Suspended on an user awaitable, resumed by the second one to arrive between this worker and the resumer
+    } else if (promise.arrivals.fetch_add(1u, std::memory_order_acq_rel) == 1u)
+        scheduleNode(node, 1u, next);
+    return 0u;
+}